@@ -25,10 +25,7 @@
 #include "../util/constants.h"
 #include "../util/fileutils.h"
 #include "../util/graphicutils.h"
-extern "C"
-{
-#include "../ffmpeg/transcode_aac.h"
-}
+#include "../ffmpeg/audioclipper.h"
 #include "../gui/playeradapter.h"
 #include "../gui/widgets/subtitlelistwidget.h"
 
@@ -103,6 +100,11 @@ extern "C"
 #define CONFIG_AUDIO_HASH       "audio-skiphash"
 #define CONFIG_AUDIO_PAD_START  "audio-pad-start"
 #define CONFIG_AUDIO_PAD_END    "audio-pad-end"
+#define CONFIG_AUDIO_EXACT      "audio-exact"
+#define CONFIG_AUDIO_CODEC      "audio-codec"
+#define CONFIG_AUDIO_BIT_RATE   "audio-bitrate"
+#define CONFIG_AUDIO_CHANNELS   "audio-channels"
+#define CONFIG_AUDIO_SAMPLE_RATE "audio-sample-rate"
 #define CONFIG_TERM             "term"
 #define CONFIG_KANJI            "kanji"
 #define CONFIG_TAGS             "tags"
@@ -326,6 +328,11 @@ bool AnkiClient::readConfigFromFile(const QString &filename)
         config->audio.name      = profile[CONFIG_AUDIO_HASH].toString();
         config->audioPadStart   = profile[CONFIG_AUDIO_PAD_START].toDouble();
         config->audioPadEnd     = profile[CONFIG_AUDIO_PAD_END].toDouble();
+        config->audioExact      = profile[CONFIG_AUDIO_EXACT].toBool(DEFAULT_AUDIO_EXACT);
+        config->audioCodec      = (AnkiConfig::AudioCodec)profile[CONFIG_AUDIO_CODEC].toInt(DEFAULT_AUDIO_CODEC);
+        config->audioBitRate    = profile[CONFIG_AUDIO_BIT_RATE].toInt(DEFAULT_AUDIO_BIT_RATE);
+        config->audioChannels   = profile[CONFIG_AUDIO_CHANNELS].toInt(DEFAULT_AUDIO_CHANNELS);
+        config->audioSampleRate = profile[CONFIG_AUDIO_SAMPLE_RATE].toInt(DEFAULT_AUDIO_SAMPLE_RATE);
         config->tags            = profile[CONFIG_TAGS].toArray();
 
         QJsonObject obj         = profile[CONFIG_TERM].toObject();
@@ -381,6 +388,11 @@ bool AnkiClient::writeConfigToFile(const QString &filename)
 //        configObj[CONFIG_AUDIO_HASH]      = config->audio.md5;
         configObj[CONFIG_AUDIO_PAD_START] = config->audioPadStart;
         configObj[CONFIG_AUDIO_PAD_END]   = config->audioPadEnd;
+        configObj[CONFIG_AUDIO_EXACT]     = config->audioExact;
+        configObj[CONFIG_AUDIO_CODEC]     = config->audioCodec;
+        configObj[CONFIG_AUDIO_BIT_RATE]  = config->audioBitRate;
+        configObj[CONFIG_AUDIO_CHANNELS]  = config->audioChannels;
+        configObj[CONFIG_AUDIO_SAMPLE_RATE] = config->audioSampleRate;
         configObj[CONFIG_TAGS]            = config->tags;
 
         QJsonObject obj;
@@ -418,6 +430,11 @@ void AnkiClient::setDefaultConfig()
 //    config->audio.md5       = SETTINGS_AUDIO_SRC_MD5_DEFAULT;
     config->audioPadStart   = DEFAULT_AUDIO_PAD_START;
     config->audioPadEnd     = DEFAULT_AUDIO_PAD_END;
+    config->audioExact      = DEFAULT_AUDIO_EXACT;
+    config->audioCodec      = DEFAULT_AUDIO_CODEC;
+    config->audioBitRate    = DEFAULT_AUDIO_BIT_RATE;
+    config->audioChannels   = DEFAULT_AUDIO_CHANNELS;
+    config->audioSampleRate = DEFAULT_AUDIO_SAMPLE_RATE;
     config->tags.append(DEFAULT_TAGS);
 
     m_configs->insert(DEFAULT_PROFILE, config);
@@ -457,6 +474,27 @@ const AnkiConfig *AnkiClient::getConfig() const
     return m_currentConfig;
 }
 
+ClipFormat AnkiClient::audioFormat(const AnkiConfig *config)
+{
+    ClipFormat format;
+    switch (config->audioCodec)
+    {
+    case AnkiConfig::AudioCodec::opus:
+        format.codec = CLIP_CODEC_OPUS;
+        break;
+    case AnkiConfig::AudioCodec::mp3:
+        format.codec = CLIP_CODEC_MP3;
+        break;
+    case AnkiConfig::AudioCodec::aac:
+    default:
+        format.codec = CLIP_CODEC_AAC;
+    }
+    format.bit_rate    = config->audioBitRate;
+    format.channels    = config->audioChannels;
+    format.sample_rate = config->audioSampleRate;
+    return format;
+}
+
 QHash<QString, AnkiConfig *> *AnkiClient::getConfigs() const
 {
     QList<QString> keys = m_configs->keys();
@@ -847,12 +885,10 @@ void AnkiClient::buildCommonNote(QJsonObject &note, QJsonObject &fieldObj,
             QJsonObject audObj;
             QTemporaryFile temp;
             if (temp.open()) {
-                QString path = temp.fileName() + ".aac";
+                QString path = temp.fileName();
                 temp.close();
                 temp.remove();
 
-                audObj[ANKI_NOTE_PATH] = path;
-
                 PlayerAdapter *player = GlobalMediator::getGlobalMediator()->getPlayerAdapter();
 
                 double startTime = player->getSubStart() + player->getSubDelay() - player->getAudioDelay() - m_currentConfig->audioPadStart;
@@ -863,19 +899,22 @@ void AnkiClient::buildCommonNote(QJsonObject &note, QJsonObject &fieldObj,
                 }
                 if (startTime < endTime)
                 {
-                    QByteArray inputFile  = player->getPath().toUtf8();
-                    QByteArray outputFile = path.toUtf8();
-                    int ret = transcode_aac(
-                        inputFile, outputFile, 
+                    QString extension = GlobalMediator::getGlobalMediator()->getAudioClipper()->clipAudio(
+                        player->getPath(),
                         player->getAudioTrack() - 1,
-                        startTime, endTime
+                        path,
+                        startTime, endTime,
+                        m_currentConfig->audioExact,
+                        audioFormat(m_currentConfig)
                     );
+                    path += extension;
 
-                    QString filename = FileUtils::calculateMd5(path) + ".aac";
+                    QString filename = FileUtils::calculateMd5(path) + extension;
+                    audObj[ANKI_NOTE_PATH] = path;
                     audObj[ANKI_NOTE_FILENAME] = filename;
                     audObj[ANKI_NOTE_FIELDS] = fieldsWithAudioMedia;
 
-                    if (ret == 0 && filename != ".aac")
+                    if (!extension.isEmpty() && filename != extension)
                     {
                         audio.append(audObj);
                     }
@@ -29,6 +29,11 @@
 
 #include "ankiconfig.h"
 
+extern "C"
+{
+#include "../ffmpeg/transcode_aac.h"
+}
+
 #include "../dict/expression.h"
 
 /* Shared Markers */
@@ -74,6 +79,11 @@
 #define DEFAULT_TAGS                    "memento"
 #define DEFAULT_AUDIO_PAD_START         0.0
 #define DEFAULT_AUDIO_PAD_END           0.0
+#define DEFAULT_AUDIO_EXACT             false
+#define DEFAULT_AUDIO_CODEC             AnkiConfig::AudioCodec::aac
+#define DEFAULT_AUDIO_BIT_RATE          96000
+#define DEFAULT_AUDIO_CHANNELS          2
+#define DEFAULT_AUDIO_SAMPLE_RATE       0
 
 class QNetworkAccessManager;
 class QNetworkReply;
@@ -110,6 +120,9 @@ public:
     const AnkiConfig             *getConfig(const QString &profile) const;
     const AnkiConfig             *getConfig()                       const;
     QHash<QString, AnkiConfig *> *getConfigs()                      const;
+
+    /* Format audio media of the profile is clipped to */
+    static ClipFormat audioFormat(const AnkiConfig *config);
     
     void clearProfiles();
 
@@ -43,6 +43,13 @@ struct AnkiConfig
         webp = 2
     };
 
+    enum AudioCodec
+    {
+        aac = 0,
+        opus = 1,
+        mp3 = 2
+    };
+
     QString         address;
     QString         port;
     DuplicatePolicy duplicatePolicy;
@@ -50,6 +57,13 @@ struct AnkiConfig
     AudioSource     audio;
     double          audioPadStart;
     double          audioPadEnd;
+    /* Transcode clips so they start exactly at the padding, instead of copying the audio when Anki can play it */
+    bool            audioExact;
+    /* Format clips are transcoded to, a sample rate of 0 keeps the one of the media */
+    AudioCodec      audioCodec;
+    int             audioBitRate;
+    int             audioChannels;
+    int             audioSampleRate;
     QJsonArray      tags;
 
     QString         termDeck;
@@ -71,6 +85,11 @@ struct AnkiConfig
         audio           = rhs.audio;
         audioPadStart   = rhs.audioPadStart;
         audioPadEnd     = rhs.audioPadEnd;
+        audioExact      = rhs.audioExact;
+        audioCodec      = rhs.audioCodec;
+        audioBitRate    = rhs.audioBitRate;
+        audioChannels   = rhs.audioChannels;
+        audioSampleRate = rhs.audioSampleRate;
         tags            = rhs.tags;
 
         termDeck        = rhs.termDeck;
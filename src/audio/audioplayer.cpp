@@ -20,6 +20,14 @@
 
 #include "audioplayer.h"
 
+#include "espeakbackend.h"
+#include "gttsbackend.h"
+#include "memoryclips.h"
+#include "originalaudiobackend.h"
+#include "ttscache.h"
+
+#include "../util/constants.h"
+#include "../util/directoryutils.h"
 #include "../util/globalmediator.h"
 
 #include <mpv/client.h>
@@ -28,10 +36,17 @@
 #include <QCoreApplication>
 #include <QNetworkAccessManager>
 #include <QThreadPool>
-#include <QFileInfo>
-#include <QProcess>
+#include <QSettings>
+
+/* Syntheses that may run at once, the rest wait in the queue */
+#define MAX_TTS_JOBS        2
+/* Prefetches leave the other jobs free, so a request to play starts right away */
+#define MAX_PREFETCH_JOBS   1
+
+/* Playback speed of slow sources */
+#define SLOW_SPEED          "0.7"
 
-AudioPlayer::AudioPlayer(QObject *parent) : QObject(parent)
+AudioPlayer::AudioPlayer(QObject *parent) : QObject(parent), m_running(0), m_prefetching(0), m_latestSlow(false)
 {
     m_mpv = mpv_create();
     if (!m_mpv)
@@ -47,6 +62,8 @@ AudioPlayer::AudioPlayer(QObject *parent) : QObject(parent)
     mpv_set_option_string(m_mpv, "terminal",       "no");
     mpv_set_option_string(m_mpv, "force-window",   "no");
     mpv_set_option_string(m_mpv, "input-terminal", "no");
+    /* Slow sources play the normal clip slower, this keeps the voice at its pitch */
+    mpv_set_option_string(m_mpv, "audio-pitch-correction", "yes");
 
     if (mpv_initialize(m_mpv) < 0)
     {
@@ -57,45 +74,78 @@ AudioPlayer::AudioPlayer(QObject *parent) : QObject(parent)
         QCoreApplication::exit(EXIT_FAILURE);
     }
 
-    QString tlds[] = {"fr", "ca"};
-    for (auto &tld : tlds) {
-        for (int slow = 0; slow <= 1; slow++) {
-            this->audioSources.push_back(AudioSource{
-                "fr-" + tld + (slow == 1 ? "-slow" : ""),
-                "fr",
-                tld,
-                bool(slow)
-            });
+    /* The first source is the default, so the gtts voices stay first */
+    m_backends.append(new GttsBackend);
+    m_backends.append(new EspeakBackend);
+    m_backends.append(new OriginalAudioBackend);
+    for (const TtsBackend *backend : m_backends)
+    {
+        for (AudioSource source : backend->sources())
+        {
+            this->audioSources.append(source);
+            source.name += "-slow";
+            source.slow = true;
+            this->audioSources.append(source);
         }
     }
+
+    QSettings settings;
+    settings.beginGroup(SETTINGS_AUDIO);
+    qint64 cacheSize = settings.value(SETTINGS_AUDIO_CACHE_SIZE, DEFAULT_AUDIO_CACHE_SIZE).toLongLong();
+    m_cache = cacheSize > 0 ? new TtsCache(DirectoryUtils::getTtsCacheDir(), cacheSize) : nullptr;
+    m_clips = new MemoryClips(settings.value(SETTINGS_AUDIO_MEMORY_SIZE, DEFAULT_AUDIO_MEMORY_SIZE).toInt());
+    m_clips->registerProtocol(m_mpv);
+    settings.endGroup();
 }
 
 AudioPlayer::~AudioPlayer()
 {
+    for (TtsJob *job : m_jobs)
+    {
+        if (job->task)
+        {
+            job->task->cancel();
+            delete job->task;
+        }
+        qDeleteAll(job->replies);
+        delete job;
+    }
+    qDeleteAll(m_backends);
     mpv_terminate_destroy(m_mpv);
-    clearFiles();
+    delete m_clips;
+    delete m_cache;
 }
 
 void AudioPlayer::clearFiles()
 {
-    m_fileLock.lock();
-    for (QTemporaryFile *file : m_files)
+    m_clips->clear();
+    if (m_cache)
     {
-        delete file;
+        m_cache->clear();
     }
-    m_files.clear();
-    m_fileLock.unlock();
 }
 
-bool AudioPlayer::playFile(const QTemporaryFile *file)
+QJsonObject AudioPlayer::memoryUsage()
+{
+    QJsonObject usage = m_cache ? m_cache->memoryUsage() : QJsonObject{{"files", 0}, {"disk", 0}, {"heap", 0}};
+    QJsonObject clips = m_clips->memoryUsage();
+    usage["memoryClips"] = clips["clips"];
+    usage["memoryBytes"] = clips["bytes"];
+    usage["heap"] = usage["heap"].toDouble() + clips["bytes"].toDouble();
+    return usage;
+}
+
+bool AudioPlayer::playFile(const QString &fileName, bool slow)
 {
-    if (file == nullptr)
+    if (fileName.isEmpty())
         return false;
 
-    QByteArray fileName = QFileInfo(*file).absoluteFilePath().toUtf8();
+    mpv_set_property_string(m_mpv, "speed", slow ? SLOW_SPEED : "1");
+
+    QByteArray path = fileName.toUtf8();
     const char *args[3] = {
         "loadfile",
-        fileName,
+        path,
         NULL
     };
     
@@ -107,67 +157,244 @@ bool AudioPlayer::playFile(const QTemporaryFile *file)
     return true;
 }
 
-AudioPlayerReply *AudioPlayer::playAudio(QString text, QString lang, QString tld, bool slow)
+TtsBackend *AudioPlayer::backend(const QString &name) const
 {
-    /* Check if the file exists */
-    m_fileLock.lock();
-    QString cacheKey = text + '\x00' + lang + '\x00' + tld + '\x00' + (slow ? 's' : 'f');  // null bytes are allowed in QString
-    QTemporaryFile *file = m_files[cacheKey];
-    if (file)
-    {
-        playFile(file);
-        m_fileLock.unlock();
+    for (TtsBackend *backend : m_backends)
+    {
+        if (backend->name() == name)
+        {
+            return backend;
+        }
+    }
+    return nullptr;
+}
+
+AudioPlayerReply *AudioPlayer::playAudio(const QString &text, const AudioSource &source)
+{
+    TtsBackend *backend = this->backend(source.backend);
+    QString context = backend ? backend->context(source) : QString();
+    QByteArray cacheKey = TtsCache::key(text, source, context);
+    m_latestKey = cacheKey;
+    m_latestSlow = source.slow;
+
+    /* Check if the clip is in memory or on disk */
+    if (m_clips->contains(cacheKey))
+    {
+        playFile(MemoryClips::url(cacheKey), source.slow);
+        return nullptr;
+    }
+    QString cached = m_cache ? m_cache->lookup(cacheKey) : QString();
+    if (!cached.isEmpty())
+    {
+        playFile(cached, source.slow);
         return nullptr;
     }
-    m_fileLock.unlock();
 
     auto *audioReply = new AudioPlayerReply;
 
-    // download audio
-    file = new QTemporaryFile;
-    // need to open temporary file to create it (otherwise fileName() will return empty string)
-    if (!file->open()) {
-        throw std::runtime_error("failed to open temporary file");
+    /* A request for audio that is already being made waits on that job */
+    TtsJob *job = m_jobs.value(cacheKey);
+    if (job == nullptr)
+    {
+        job = new TtsJob{cacheKey, text, source, context, false};
+        m_jobs.insert(cacheKey, job);
+    }
+    else if (job->prefetch)
+    {
+        job->prefetch = false;
+        if (job->task)
+        {
+            --m_prefetching;
+        }
+    }
+    job->replies.append(audioReply);
+
+    /* Only the newest request is wanted, older ones that have not started are dropped */
+    QList<TtsJob *> prefetches;
+    for (TtsJob *queued : m_queue)
+    {
+        if (queued == job)
+        {
+            continue;
+        }
+        else if (queued->prefetch)
+        {
+            prefetches.append(queued);
+        }
+        else
+        {
+            cancelJob(queued);
+        }
+    }
+    m_queue = prefetches;
+    if (job->task == nullptr)
+    {
+        m_queue.prepend(job);
+    }
+    startJobs();
+
+    return audioReply;
+}
+
+void AudioPlayer::prefetchAudio(const QStringList &texts, const AudioSource &source)
+{
+    /* Keep the running ones, they are likely still wanted */
+    QList<TtsJob *> requests;
+    for (TtsJob *queued : m_queue)
+    {
+        if (queued->prefetch)
+        {
+            cancelJob(queued);
+        }
+        else
+        {
+            requests.append(queued);
+        }
+    }
+    m_queue = requests;
+
+    TtsBackend *backend = this->backend(source.backend);
+    QString context = backend ? backend->context(source) : QString();
+    for (const QString &text : texts)
+    {
+        QByteArray cacheKey = TtsCache::key(text, source, context);
+        if (m_jobs.contains(cacheKey) || m_clips->contains(cacheKey) || (m_cache && m_cache->contains(cacheKey)))
+        {
+            continue;
+        }
+        TtsJob *job = new TtsJob{cacheKey, text, source, context, true};
+        m_jobs.insert(cacheKey, job);
+        m_queue.append(job);
     }
-    file->close();
+    startJobs();
+}
 
-    QProcess *process = new QProcess;
+void AudioPlayer::cancelPrefetch()
+{
+    QList<TtsJob *> requests;
+    for (TtsJob *queued : m_queue)
+    {
+        if (queued->prefetch)
+        {
+            cancelJob(queued);
+        }
+        else
+        {
+            requests.append(queued);
+        }
+    }
+    m_queue = requests;
 
-    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), [=](int statusCode, QProcess::ExitStatus exitStatus) {
-        if (statusCode == 0 && exitStatus == QProcess::NormalExit) {
-            // add to cache
-            m_fileLock.lock();
-            m_files[cacheKey] = file;
+    for (TtsJob *job : m_jobs.values())
+    {
+        if (job->prefetch && job->task)
+        {
+            stopJob(job);
+        }
+    }
+    startJobs();
+}
 
-            bool res = this->playFile(file);
-            m_fileLock.unlock();
-            Q_EMIT audioReply->result(res);
-        } else {
-            qDebug() << "process failed with status code" << statusCode << "exit status" << exitStatus << "stderr" << process->readAllStandardError();
-            Q_EMIT audioReply->result(false);
+void AudioPlayer::startJobs()
+{
+    while (m_running < MAX_TTS_JOBS && !m_queue.isEmpty())
+    {
+        if (m_queue.first()->prefetch && m_prefetching >= MAX_PREFETCH_JOBS)
+        {
+            break;
         }
+        startJob(m_queue.takeFirst());
+    }
+}
+
+void AudioPlayer::startJob(TtsJob *job)
+{
+    TtsBackend *backend = this->backend(job->source.backend);
+    if (backend == nullptr)
+    {
+        qDebug() << "no tts backend named" << job->source.backend;
+        m_jobs.remove(job->key);
+        for (AudioPlayerReply *reply : job->replies)
+        {
+            Q_EMIT reply->result(false);
+            reply->deleteLater();
+        }
+        delete job;
+        return;
+    }
+
+    job->task = backend->synthesize(job->text, job->source, job->context);
+    ++m_running;
+    if (job->prefetch)
+    {
+        ++m_prefetching;
+    }
+    connect(job->task, &TtsTask::finished, this, [=] (const bool success) { finishJob(job, success); });
+}
+
+void AudioPlayer::finishJob(TtsJob *job, bool success)
+{
+    --m_running;
+    if (job->prefetch)
+    {
+        --m_prefetching;
+    }
+    m_jobs.remove(job->key);
 
-        process->deleteLater();
-        audioReply->deleteLater();
-    });
-    connect(process, &QProcess::errorOccurred, [=](QProcess::ProcessError error) {
-        if (error == QProcess::FailedToStart) {
-            qDebug() << "process failed to start" << process->errorString();
-            Q_EMIT audioReply->result(false);
-            audioReply->deleteLater();
-            process->deleteLater();
+    // add to cache, it is played from memory even if it could not be written to disk
+    bool res = false;
+    if (success)
+    {
+        QByteArray audio = job->task->audio();
+        m_clips->insert(job->key, audio);
+        QString path = m_cache ? m_cache->insert(job->key, audio) : QString();
+
+        /* A clip bigger than the memory cache is only on disk */
+        QString url = m_clips->contains(job->key) ? MemoryClips::url(job->key) : path;
+        res = !url.isEmpty();
+        if (res && !job->replies.isEmpty() && job->key == m_latestKey)
+        {
+            res = playFile(url, m_latestSlow);
         }
-    });
+    }
+    for (AudioPlayerReply *reply : job->replies)
+    {
+        Q_EMIT reply->result(res);
+        reply->deleteLater();
+    }
+
+    job->task->deleteLater();
+    delete job;
 
-    QStringList args;
-    args << "--lang" << lang << "--nocheck" << "--tld" << tld << "--output" << QFileInfo(*file).absoluteFilePath();
-    if (slow) {
-        args << "--slow";
+    startJobs();
+}
+
+void AudioPlayer::cancelJob(TtsJob *job)
+{
+    m_jobs.remove(job->key);
+    for (AudioPlayerReply *reply : job->replies)
+    {
+        Q_EMIT reply->cancelled();
+        reply->deleteLater();
     }
-    args << "--" << text;
+    delete job;
+}
 
-    qDebug() << "run gtts-cli" << args;
-    process->start("gtts-cli", args);
+void AudioPlayer::stopJob(TtsJob *job)
+{
+    --m_running;
+    if (job->prefetch)
+    {
+        --m_prefetching;
+    }
+    m_jobs.remove(job->key);
+    for (AudioPlayerReply *reply : job->replies)
+    {
+        Q_EMIT reply->cancelled();
+        reply->deleteLater();
+    }
 
-    return audioReply;
+    job->task->cancel();
+    job->task->deleteLater();
+    delete job;
 }
@@ -21,14 +21,17 @@
 #ifndef AUDIOPLAYER_H
 #define AUDIOPLAYER_H
 
+#include "ttsbackend.h"
+
+#include <QHash>
+#include <QJsonObject>
 #include <QList>
 #include <QObject>
-#include <QTemporaryFile>
-#include <QMutex>
-#include <QProcess>
 
 struct mpv_handle;
 class QNetworkAccessManager;
+class MemoryClips;
+class TtsCache;
 
 class AudioPlayerReply : public QObject
 {
@@ -38,13 +41,8 @@ public:
 
 Q_SIGNALS:
     void result(const bool success);
-};
-
-struct AudioSource {
-    QString name;
-    QString lang;
-    QString tld;
-    bool slow = false;
+    /* A newer request took its place before it started, result is not emitted */
+    void cancelled();
 };
 
 class AudioPlayer : public QObject
@@ -54,17 +52,70 @@ public:
     AudioPlayer(QObject *parent = nullptr);
     ~AudioPlayer();
 
+    /* Removes every cached speech clip, in memory and on disk */
     void clearFiles();
 
-    AudioPlayerReply *playAudio(QString text, QString language, QString tld, bool slow);
+    /* Number of cached speech files, their size on disk, the clips in memory and the heap used by both */
+    QJsonObject memoryUsage();
+
+    /**
+     * Plays the audio straight away if it is cached, otherwise queues its synthesis
+     * @return nullptr if it was cached, deleted after it emits result or cancelled
+     */
+    AudioPlayerReply *playAudio(const QString &text, const AudioSource &source);
+
+    /**
+     * Synthesizes audio ahead of time in the background, behind any requests to play.
+     * Replaces the texts of an earlier prefetch that have not started yet.
+     * @param texts most wanted first
+     */
+    void prefetchAudio(const QStringList &texts, const AudioSource &source);
+    /* Drops queued prefetches and stops the running ones */
+    void cancelPrefetch();
+
     QList<AudioSource> audioSources;
 
 private:
+    /* One synthesis, shared by every request for the same audio while it is queued or running */
+    struct TtsJob
+    {
+        QByteArray key;
+        QString text;
+        AudioSource source;
+        QString context;
+        /* Nobody asked to play it yet, it runs after the jobs that were */
+        bool prefetch;
+        QList<AudioPlayerReply *> replies;
+        TtsTask *task = nullptr;
+    };
+
     mpv_handle *m_mpv;
-    QHash<QString, QTemporaryFile *> m_files;
-    QMutex m_fileLock;
+    /* nullptr if speech is kept off the disk */
+    TtsCache *m_cache;
+    MemoryClips *m_clips;
+    QList<TtsBackend *> m_backends;
+
+    /* Jobs are only touched from the thread the player lives in, so they need no lock */
+    QHash<QByteArray, TtsJob *> m_jobs;
+    /* Requests to play come first, then prefetches */
+    QList<TtsJob *> m_queue;
+    int m_running;
+    int m_prefetching;
+    /* Key of the newest request, a job that finishes after a newer request is cached but not played */
+    QByteArray m_latestKey;
+    bool m_latestSlow;
+
+    /* nullptr if there is no backend with the name */
+    TtsBackend *backend(const QString &name) const;
+
+    /* Plays a file or a url mpv can open, time stretched without changing pitch if slow */
+    bool playFile(const QString &fileName, bool slow);
 
-    bool playFile(const QTemporaryFile *file);
+    void startJobs();
+    void startJob(TtsJob *job);
+    void finishJob(TtsJob *job, bool success);
+    void cancelJob(TtsJob *job);
+    void stopJob(TtsJob *job);
 };
 
 #endif // AUDIOPLAYER_H
\ No newline at end of file
@@ -0,0 +1,128 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "espeakbackend.h"
+
+#include <QDebug>
+#include <QMutex>
+
+/* Values from espeak-ng's speak_lib.h, which is not needed to build */
+#define AUDIO_OUTPUT_SYNCHRONOUS    2
+#define EE_OK                       0
+#define POS_CHARACTER               1
+#define ESPEAK_CHARS_UTF8           1
+#define ESPEAK_RATE                 1
+
+/* Words per minute */
+#define NORMAL_RATE                 175
+
+/* espeak-ng keeps its voice, parameters and callback globally, so one synthesis runs at a time */
+static QMutex espeakLock;
+static QByteArray *currentOutput = nullptr;
+static const std::atomic<bool> *currentCancelled = nullptr;
+
+EspeakBackend::EspeakBackend(QObject *parent) : QObject(parent),
+                                                m_initialize(nullptr),
+                                                m_setSynthCallback(nullptr),
+                                                m_setVoiceByName(nullptr),
+                                                m_setParameter(nullptr),
+                                                m_synth(nullptr),
+                                                m_sampleRate(0)
+{
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+    m_library.setFileName("libespeak-ng");
+#else
+    m_library.setFileNameAndVersion("espeak-ng", 1);
+#endif
+    if (!m_library.load())
+    {
+        qDebug() << "espeak-ng is not available:" << m_library.errorString();
+        return;
+    }
+
+    m_initialize = reinterpret_cast<decltype(m_initialize)>(m_library.resolve("espeak_Initialize"));
+    m_setSynthCallback = reinterpret_cast<decltype(m_setSynthCallback)>(m_library.resolve("espeak_SetSynthCallback"));
+    m_setVoiceByName = reinterpret_cast<decltype(m_setVoiceByName)>(m_library.resolve("espeak_SetVoiceByName"));
+    m_setParameter = reinterpret_cast<decltype(m_setParameter)>(m_library.resolve("espeak_SetParameter"));
+    m_synth = reinterpret_cast<decltype(m_synth)>(m_library.resolve("espeak_Synth"));
+    if (!m_initialize || !m_setSynthCallback || !m_setVoiceByName || !m_setParameter || !m_synth)
+    {
+        qDebug() << "espeak-ng is missing functions, not using it";
+        m_initialize = nullptr;
+        m_library.unload();
+    }
+}
+
+QString EspeakBackend::name() const
+{
+    return "espeak";
+}
+
+QList<AudioSource> EspeakBackend::sources() const
+{
+    if (m_initialize == nullptr)
+    {
+        return {};
+    }
+    return {AudioSource{"fr-espeak", "fr", "", false, name()}};
+}
+
+TtsTask *EspeakBackend::synthesize(const QString &text, const AudioSource &source, const QString &context)
+{
+    Q_UNUSED(context);
+    return new ThreadPoolTask([=] (const std::atomic<bool> &cancelled) { return speak(text, source, cancelled); });
+}
+
+QByteArray EspeakBackend::speak(const QString &text, const AudioSource &source, const std::atomic<bool> &cancelled)
+{
+    QMutexLocker locker(&espeakLock);
+    if (cancelled)
+    {
+        return QByteArray();
+    }
+
+    if (m_sampleRate == 0)
+    {
+        int sampleRate = m_initialize(AUDIO_OUTPUT_SYNCHRONOUS, 0, nullptr, 0);
+        if (sampleRate <= 0)
+        {
+            qDebug() << "could not initialize espeak-ng";
+            return QByteArray();
+        }
+        m_setSynthCallback(onSamples);
+        m_sampleRate = sampleRate;
+    }
+    if (m_setVoiceByName(source.lang.toUtf8().constData()) != EE_OK)
+    {
+        qDebug() << "espeak-ng has no voice for" << source.lang;
+        return QByteArray();
+    }
+    m_setParameter(ESPEAK_RATE, NORMAL_RATE, 0);
+
+    /* Synchronous output calls onSamples before espeak_Synth returns */
+    QByteArray pcm;
+    currentOutput = &pcm;
+    currentCancelled = &cancelled;
+    QByteArray utf8 = text.toUtf8();
+    int error = m_synth(utf8.constData(), utf8.size() + 1, 0, POS_CHARACTER, 0, ESPEAK_CHARS_UTF8, nullptr, nullptr);
+    currentOutput = nullptr;
+    currentCancelled = nullptr;
+
+    if (error != EE_OK || cancelled || pcm.isEmpty())
+    {
+        return QByteArray();
+    }
+    return wavFile(pcm, m_sampleRate);
+}
+
+int EspeakBackend::onSamples(short *wav, int numSamples, void *events)
+{
+    Q_UNUSED(events);
+    if (wav != nullptr && numSamples > 0)
+    {
+        currentOutput->append(reinterpret_cast<const char *>(wav), numSamples * sizeof(short));
+    }
+    /* Non zero stops the synthesis */
+    return *currentCancelled ? 1 : 0;
+}
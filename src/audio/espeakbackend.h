@@ -0,0 +1,45 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef ESPEAKBACKEND_H
+#define ESPEAKBACKEND_H
+
+#include "ttsbackend.h"
+
+#include <QLibrary>
+
+/**
+ * Offline speech from espeak-ng, synthesized in process on the global thread pool.
+ * The library is loaded at run time so it is not needed to build or run Memento.
+ */
+class EspeakBackend : public QObject, public TtsBackend
+{
+    Q_OBJECT
+public:
+    EspeakBackend(QObject *parent = nullptr);
+
+    QString name() const override;
+    QList<AudioSource> sources() const override;
+    TtsTask *synthesize(const QString &text, const AudioSource &source, const QString &context) override;
+
+private:
+    typedef int (*SynthCallback)(short *wav, int numSamples, void *events);
+
+    QLibrary m_library;
+    int (*m_initialize)(int output, int bufferLength, const char *path, int options);
+    void (*m_setSynthCallback)(SynthCallback callback);
+    int (*m_setVoiceByName)(const char *name);
+    int (*m_setParameter)(int parameter, int value, int relative);
+    int (*m_synth)(const void *text, size_t size, unsigned int position, int positionType,
+                   unsigned int endPosition, unsigned int flags, unsigned int *id, void *userData);
+
+    /* 0 until espeak-ng is initialized by the first synthesis */
+    int m_sampleRate;
+
+    /* PCM of text as a wav file, empty if it failed or was cancelled. Runs on a pool thread */
+    QByteArray speak(const QString &text, const AudioSource &source, const std::atomic<bool> &cancelled);
+    static int onSamples(short *wav, int numSamples, void *events);
+};
+
+#endif // ESPEAKBACKEND_H
@@ -0,0 +1,61 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "gttsbackend.h"
+
+#include <QDebug>
+
+QString GttsBackend::name() const
+{
+    return "gtts";
+}
+
+QList<AudioSource> GttsBackend::sources() const
+{
+    QList<AudioSource> sources;
+    QString tlds[] = {"fr", "ca"};
+    for (auto &tld : tlds) {
+        sources.push_back(AudioSource{"fr-" + tld, "fr", tld, false, name()});
+    }
+    return sources;
+}
+
+TtsTask *GttsBackend::synthesize(const QString &text, const AudioSource &source, const QString &context)
+{
+    Q_UNUSED(context);
+    return new GttsTask(text, source);
+}
+
+GttsTask::GttsTask(const QString &text, const AudioSource &source, QObject *parent) : TtsTask(parent), m_process(this)
+{
+    connect(&m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [=](int statusCode, QProcess::ExitStatus exitStatus) {
+        if (statusCode == 0 && exitStatus == QProcess::NormalExit) {
+            m_audio = m_process.readAllStandardOutput();
+            Q_EMIT finished(!m_audio.isEmpty());
+        } else {
+            qDebug() << "process failed with status code" << statusCode << "exit status" << exitStatus << "stderr" << m_process.readAllStandardError();
+            Q_EMIT finished(false);
+        }
+    });
+    connect(&m_process, &QProcess::errorOccurred, this, [=](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            qDebug() << "process failed to start" << m_process.errorString();
+            Q_EMIT finished(false);
+        }
+    });
+
+    // without --output the mp3 is written to stdout
+    QStringList args;
+    args << "--lang" << source.lang << "--nocheck" << "--tld" << source.tld;
+    args << "--" << text;
+
+    qDebug() << "run gtts-cli" << args;
+    m_process.start("gtts-cli", args);
+}
+
+void GttsTask::cancel()
+{
+    m_process.disconnect(this);
+    m_process.kill();
+}
@@ -0,0 +1,33 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef GTTSBACKEND_H
+#define GTTSBACKEND_H
+
+#include "ttsbackend.h"
+
+#include <QProcess>
+
+/* Google Translate speech through a gtts-cli process, needs the network */
+class GttsBackend : public TtsBackend
+{
+public:
+    QString name() const override;
+    QList<AudioSource> sources() const override;
+    TtsTask *synthesize(const QString &text, const AudioSource &source, const QString &context) override;
+};
+
+class GttsTask : public TtsTask
+{
+    Q_OBJECT
+public:
+    GttsTask(const QString &text, const AudioSource &source, QObject *parent = nullptr);
+
+    void cancel() override;
+
+private:
+    QProcess m_process;
+};
+
+#endif // GTTSBACKEND_H
@@ -0,0 +1,121 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "memoryclips.h"
+
+#include <mpv/client.h>
+#include <mpv/stream_cb.h>
+
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+#define PROTOCOL "memento-tts"
+
+/* A clip mpv has open, the data is shared with the cache */
+struct ClipStream
+{
+    QByteArray data;
+    qint64 position;
+};
+
+MemoryClips::MemoryClips(int maxSize) : m_clips(maxSize) {}
+
+bool MemoryClips::registerProtocol(mpv_handle *mpv)
+{
+    if (mpv_stream_cb_add_ro(mpv, PROTOCOL, this, &MemoryClips::openStream) < 0)
+    {
+        qDebug() << "could not register the" << PROTOCOL << "protocol with mpv";
+        return false;
+    }
+    return true;
+}
+
+QString MemoryClips::url(const QByteArray &key)
+{
+    return QString(PROTOCOL "://") + QString::fromLatin1(key);
+}
+
+bool MemoryClips::contains(const QByteArray &key)
+{
+    QMutexLocker locker(&m_lock);
+    return m_clips.contains(key);
+}
+
+void MemoryClips::insert(const QByteArray &key, const QByteArray &audio)
+{
+    QMutexLocker locker(&m_lock);
+    /* Clips bigger than the whole cache are not kept */
+    m_clips.insert(key, new QByteArray(audio), audio.size());
+}
+
+void MemoryClips::clear()
+{
+    QMutexLocker locker(&m_lock);
+    m_clips.clear();
+}
+
+QByteArray MemoryClips::clip(const QByteArray &key)
+{
+    QMutexLocker locker(&m_lock);
+    QByteArray *audio = m_clips.object(key);
+    return audio ? *audio : QByteArray();
+}
+
+QJsonObject MemoryClips::memoryUsage()
+{
+    QMutexLocker locker(&m_lock);
+    return QJsonObject{
+        {"clips", m_clips.count()},
+        {"bytes", m_clips.totalCost()}
+    };
+}
+
+static int64_t readStream(void *cookie, char *buf, uint64_t numBytes)
+{
+    ClipStream *stream = static_cast<ClipStream *>(cookie);
+    qint64 size = std::min<qint64>(numBytes, stream->data.size() - stream->position);
+    std::memcpy(buf, stream->data.constData() + stream->position, size);
+    stream->position += size;
+    return size;
+}
+
+static int64_t seekStream(void *cookie, int64_t offset)
+{
+    ClipStream *stream = static_cast<ClipStream *>(cookie);
+    if (offset < 0 || offset > stream->data.size())
+    {
+        return MPV_ERROR_GENERIC;
+    }
+    stream->position = offset;
+    return offset;
+}
+
+static int64_t streamSize(void *cookie)
+{
+    return static_cast<ClipStream *>(cookie)->data.size();
+}
+
+static void closeStream(void *cookie)
+{
+    delete static_cast<ClipStream *>(cookie);
+}
+
+/* Called from an mpv thread */
+int MemoryClips::openStream(void *userData, char *uri, mpv_stream_cb_info *info)
+{
+    QByteArray key = QByteArray(uri).mid(std::strlen(PROTOCOL "://"));
+    QByteArray data = static_cast<MemoryClips *>(userData)->clip(key);
+    if (data.isEmpty())
+    {
+        return MPV_ERROR_LOADING_FAILED;
+    }
+
+    info->cookie = new ClipStream{data, 0};
+    info->read_fn = readStream;
+    info->seek_fn = seekStream;
+    info->size_fn = streamSize;
+    info->close_fn = closeStream;
+    return 0;
+}
@@ -0,0 +1,48 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMORYCLIPS_H
+#define MEMORYCLIPS_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+
+struct mpv_handle;
+
+/**
+ * Synthesized speech kept in memory, the least recently used clips are dropped over the size cap.
+ * mpv reads the clips through a stream protocol, so playing them never touches the disk. Thread safe.
+ */
+class MemoryClips
+{
+public:
+    MemoryClips(int maxSize);
+
+    /* Lets mpv open url(key) for the clips in this cache */
+    bool registerProtocol(mpv_handle *mpv);
+
+    /* Url mpv can load the clip from while it is cached */
+    static QString url(const QByteArray &key);
+
+    bool contains(const QByteArray &key);
+    void insert(const QByteArray &key, const QByteArray &audio);
+    void clear();
+
+    /* Number of clips and the bytes they hold */
+    QJsonObject memoryUsage();
+
+private:
+    QCache<QByteArray, QByteArray> m_clips;
+    QMutex m_lock;
+
+    /* Copy of the clip, shares its data so it stays readable if the clip is evicted while mpv plays it */
+    QByteArray clip(const QByteArray &key);
+
+    static int openStream(void *userData, char *uri, struct mpv_stream_cb_info *info);
+};
+
+#endif // MEMORYCLIPS_H
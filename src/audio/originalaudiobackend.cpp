@@ -0,0 +1,137 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "originalaudiobackend.h"
+
+#include "../ffmpeg/audioclipper.h"
+#include "../gui/playeradapter.h"
+#include "../util/constants.h"
+#include "../util/globalmediator.h"
+
+#include <QDebug>
+#include <QSettings>
+#include <QStringList>
+
+/* Bytes of decoded lines that are kept */
+#define DECODED_CACHE_SIZE  (16 * 1024 * 1024)
+
+/* Seconds kept around a phrase, the guess of where it is spoken is rough */
+#define PHRASE_PADDING      0.15
+
+/* Separates the fields of a context, subtitles and paths never contain it */
+#define CONTEXT_SEPARATOR   QChar('\0')
+
+OriginalAudioBackend::OriginalAudioBackend(QObject *parent) : QObject(parent), m_decoded(DECODED_CACHE_SIZE)
+{
+    connect(GlobalMediator::getGlobalMediator(), &GlobalMediator::playerSubtitleChanged, this,
+        [=] (QString subtitle, const double start, const double end, const double delay) {
+            Q_UNUSED(start);
+            Q_UNUSED(end);
+            Q_UNUSED(delay);
+            m_subtitle = subtitle;
+        }
+    );
+}
+
+QString OriginalAudioBackend::name() const
+{
+    return "original";
+}
+
+QList<AudioSource> OriginalAudioBackend::sources() const
+{
+    return {AudioSource{"original", "", "", false, name()}};
+}
+
+QString OriginalAudioBackend::context(const AudioSource &source) const
+{
+    Q_UNUSED(source);
+    PlayerAdapter *player = GlobalMediator::getGlobalMediator()->getPlayerAdapter();
+    if (player == nullptr || player->getPath().isEmpty() || m_subtitle.isEmpty())
+    {
+        return QString();
+    }
+
+    QSettings settings;
+    settings.beginGroup(SETTINGS_AUDIO);
+    bool narrow = settings.value(SETTINGS_AUDIO_ORIGINAL_NARROW, DEFAULT_AUDIO_ORIGINAL_NARROW).toBool();
+    settings.endGroup();
+
+    /* Same times as the audio of Anki cards */
+    double offset = player->getSubDelay() - player->getAudioDelay();
+    return QStringList{
+        player->getPath(),
+        QString::number(player->getAudioTrack() - 1),
+        QString::number(player->getSubStart() + offset, 'f', 3),
+        QString::number(player->getSubEnd() + offset, 'f', 3),
+        narrow ? "narrow" : "line",
+        m_subtitle
+    }.join(CONTEXT_SEPARATOR);
+}
+
+TtsTask *OriginalAudioBackend::synthesize(const QString &text, const AudioSource &source, const QString &context)
+{
+    Q_UNUSED(source);
+    return new ThreadPoolTask([=] (const std::atomic<bool> &cancelled) { return clip(text, context, cancelled); });
+}
+
+QByteArray OriginalAudioBackend::clip(const QString &text, const QString &context, const std::atomic<bool> &cancelled)
+{
+    QStringList fields = context.split(CONTEXT_SEPARATOR);
+    if (fields.size() != 6)
+    {
+        qDebug() << "no subtitle to take original audio from";
+        return QByteArray();
+    }
+    bool narrow = fields[4] == "narrow";
+    const QString &subtitle = fields[5];
+    /* Every phrase of a line shares its decoded audio */
+    QString line = QStringList(fields.mid(0, 4)).join(CONTEXT_SEPARATOR);
+
+    QMutexLocker locker(&m_lock);
+    if (cancelled)
+    {
+        return QByteArray();
+    }
+
+    Pcm *pcm = m_decoded.object(line);
+    if (pcm == nullptr)
+    {
+        int sampleRate = 0;
+        QByteArray samples = GlobalMediator::getGlobalMediator()->getAudioClipper()->decodePcm(
+            fields[0], fields[1].toULongLong(), fields[2].toDouble(), fields[3].toDouble(), sampleRate
+        );
+        if (samples.isEmpty())
+        {
+            qDebug() << "could not decode the audio of" << fields[0] << "from" << fields[2] << "to" << fields[3];
+            return QByteArray();
+        }
+        pcm = new Pcm{samples, sampleRate};
+
+        int cost = pcm->samples.size();
+        if (!m_decoded.insert(line, pcm, cost))
+        {
+            /* Bigger than the whole cache, it was deleted */
+            return QByteArray();
+        }
+    }
+    if (cancelled)
+    {
+        return QByteArray();
+    }
+
+    /* Assumes the line is spoken at an even pace, a phrase takes the share of the time it takes of the text */
+    qint64 numSamples = pcm->samples.size() / sizeof(int16_t);
+    qint64 first = 0;
+    qint64 last = numSamples;
+    int index = subtitle.indexOf(text);
+    if (narrow && index != -1)
+    {
+        qint64 padding = PHRASE_PADDING * pcm->sampleRate;
+        first = qMax<qint64>(0, numSamples * index / subtitle.size() - padding);
+        last = qMin<qint64>(numSamples, numSamples * (index + text.size()) / subtitle.size() + padding);
+    }
+
+    return wavFile(pcm->samples.mid(first * sizeof(int16_t), (last - first) * sizeof(int16_t)), pcm->sampleRate);
+}
@@ -0,0 +1,48 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef ORIGINALAUDIOBACKEND_H
+#define ORIGINALAUDIOBACKEND_H
+
+#include "ttsbackend.h"
+
+#include <QCache>
+#include <QMutex>
+
+/**
+ * The actor's own voice, clipped from the audio track of the file that is playing.
+ * The current line is decoded once and kept, phrases of it are cut out by where they are in the text.
+ */
+class OriginalAudioBackend : public QObject, public TtsBackend
+{
+    Q_OBJECT
+public:
+    OriginalAudioBackend(QObject *parent = nullptr);
+
+    QString name() const override;
+    QList<AudioSource> sources() const override;
+    /* The file, audio track, times and text of the current line and whether phrases are cut from it */
+    QString context(const AudioSource &source) const override;
+    TtsTask *synthesize(const QString &text, const AudioSource &source, const QString &context) override;
+
+private:
+    /* Signed 16 bit mono samples of a line */
+    struct Pcm
+    {
+        QByteArray samples;
+        int sampleRate;
+    };
+
+    QString m_subtitle;
+
+    /* Decoded lines by context, only touched on pool threads while holding m_lock */
+    QCache<QString, Pcm> m_decoded;
+    /* Held while decoding, so the phrases of a line wait for the one decode instead of each doing it */
+    QMutex m_lock;
+
+    /* The phrase as a wav file, empty if it failed or was cancelled. Runs on a pool thread */
+    QByteArray clip(const QString &text, const QString &context, const std::atomic<bool> &cancelled);
+};
+
+#endif // ORIGINALAUDIOBACKEND_H
@@ -0,0 +1,68 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "ttsbackend.h"
+
+#include <QCoreApplication>
+#include <QThreadPool>
+#include <QtEndian>
+
+ThreadPoolTask::ThreadPoolTask(std::function<QByteArray(const std::atomic<bool> &cancelled)> speak, QObject *parent)
+    : TtsTask(parent), m_cancelled(std::make_shared<std::atomic<bool>>(false))
+{
+    std::shared_ptr<std::atomic<bool>> cancelled = m_cancelled;
+    QThreadPool::globalInstance()->start(
+        [=] {
+            QByteArray audio = speak(*cancelled);
+
+            QMetaObject::invokeMethod(QCoreApplication::instance(),
+                [=] {
+                    /* A task is only deleted once it finished or was cancelled */
+                    if (!*cancelled)
+                    {
+                        m_audio = audio;
+                        Q_EMIT finished(!audio.isEmpty());
+                    }
+                },
+                Qt::QueuedConnection
+            );
+        }
+    );
+}
+
+void ThreadPoolTask::cancel()
+{
+    *m_cancelled = true;
+}
+
+static void appendUInt16(QByteArray &out, quint16 value)
+{
+    value = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void appendUInt32(QByteArray &out, quint32 value)
+{
+    value = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+QByteArray TtsBackend::wavFile(const QByteArray &pcm, quint32 sampleRate)
+{
+    QByteArray wav("RIFF");
+    wav.reserve(44 + pcm.size());
+    appendUInt32(wav, 36 + pcm.size());
+    wav.append("WAVEfmt ");
+    appendUInt32(wav, 16);
+    appendUInt16(wav, 1);                // PCM
+    appendUInt16(wav, 1);                // channels
+    appendUInt32(wav, sampleRate);
+    appendUInt32(wav, sampleRate * 2);   // bytes per second
+    appendUInt16(wav, 2);                // bytes per frame
+    appendUInt16(wav, 16);               // bits per sample
+    wav.append("data");
+    appendUInt32(wav, pcm.size());
+    wav.append(pcm);
+    return wav;
+}
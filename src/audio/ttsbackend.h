@@ -0,0 +1,84 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef TTSBACKEND_H
+#define TTSBACKEND_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+struct AudioSource {
+    QString name;
+    QString lang;
+    QString tld;
+    /* Played at a lower speed, it is the same clip as the normal source */
+    bool slow = false;
+    /* Name of the TtsBackend that speaks it */
+    QString backend;
+};
+
+/* One synthesis started by a TtsBackend, lives in the thread it was started from */
+class TtsTask : public QObject
+{
+    Q_OBJECT
+public:
+    using QObject::QObject;
+
+    /* Stops the synthesis, finished is not emitted afterwards */
+    virtual void cancel() = 0;
+
+    /* Encoded audio once finished was emitted with success */
+    QByteArray audio() const { return m_audio; }
+
+Q_SIGNALS:
+    void finished(const bool success);
+
+protected:
+    QByteArray m_audio;
+};
+
+/* Runs a synthesis on the global thread pool, finished is emitted in the main thread */
+class ThreadPoolTask : public TtsTask
+{
+    Q_OBJECT
+public:
+    /* speak returns the encoded audio or nothing if it failed, it should give up once cancelled is set */
+    ThreadPoolTask(std::function<QByteArray(const std::atomic<bool> &cancelled)> speak, QObject *parent = nullptr);
+
+    void cancel() override;
+
+private:
+    /* Shared with the pool thread, which may still be running after the task is deleted */
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+/* A speech engine AudioPlayer can synthesize with */
+class TtsBackend
+{
+public:
+    virtual ~TtsBackend() {}
+
+    /* Part of the cache key of everything it synthesizes, changing it drops its cached clips */
+    virtual QString name() const = 0;
+
+    /* Voices it offers at normal speed, empty if the engine is not available */
+    virtual QList<AudioSource> sources() const = 0;
+
+    /* What the audio depends on besides the text, taken when it is requested and part of its cache key */
+    virtual QString context(const AudioSource &source) const { Q_UNUSED(source); return QString(); }
+
+    /* Starts synthesizing text at normal speed, the caller deletes the task after it finished or was cancelled */
+    virtual TtsTask *synthesize(const QString &text, const AudioSource &source, const QString &context) = 0;
+
+protected:
+    /* 16 bit mono PCM as a wav file */
+    static QByteArray wavFile(const QByteArray &pcm, quint32 sampleRate);
+};
+
+#endif // TTSBACKEND_H
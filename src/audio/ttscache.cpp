@@ -0,0 +1,264 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "ttscache.h"
+
+#include "../util/memoryutils.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+#include <QSaveFile>
+#include <QVector>
+#include <algorithm>
+
+#define INDEX_FILE      "index"
+#define INDEX_MAGIC     0x54545343 // "TTSC"
+#define INDEX_VERSION   1
+#define CLIP_SUFFIX     ".clip"
+
+TtsCache::TtsCache(const QString &dirName, qint64 maxSize)
+    : m_dir(dirName), m_maxSize(maxSize), m_size(0), m_clock(0), m_dirty(false)
+{
+    if (!QDir().mkpath(m_dir))
+    {
+        qDebug() << "could not create tts cache directory" << m_dir;
+    }
+    if (!readIndex())
+    {
+        rebuildIndex();
+    }
+}
+
+TtsCache::~TtsCache()
+{
+    save();
+}
+
+QByteArray TtsCache::key(const QString &text, const AudioSource &source, const QString &context)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(source.backend.toUtf8());
+    hash.addData(QByteArray(1, '\0') + text.toUtf8());
+    hash.addData(QByteArray(1, '\0') + source.lang.toUtf8());
+    hash.addData(QByteArray(1, '\0') + source.tld.toUtf8());
+    /* Left out when empty so the keys of clips cached before it existed stay the same */
+    if (!context.isEmpty())
+    {
+        hash.addData(QByteArray(1, '\0') + context.toUtf8());
+    }
+    return hash.result().toHex();
+}
+
+QString TtsCache::filePath(const QByteArray &key) const
+{
+    return m_dir + QString::fromLatin1(key) + CLIP_SUFFIX;
+}
+
+QString TtsCache::lookup(const QByteArray &key)
+{
+    QMutexLocker locker(&m_lock);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        return QString();
+    }
+
+    /* The clip may have been removed by hand */
+    QString path = filePath(key);
+    if (!QFile::exists(path))
+    {
+        m_size -= it->size;
+        m_entries.erase(it);
+        m_dirty = true;
+        return QString();
+    }
+
+    it->lastUsed = ++m_clock;
+    m_dirty = true;
+    return path;
+}
+
+bool TtsCache::contains(const QByteArray &key)
+{
+    QMutexLocker locker(&m_lock);
+    return m_entries.contains(key);
+}
+
+QString TtsCache::insert(const QByteArray &key, const QByteArray &audio)
+{
+    QMutexLocker locker(&m_lock);
+    QString path = filePath(key);
+
+    QSaveFile file(path);
+    if (!file.open(QFile::WriteOnly) || file.write(audio) != audio.size() || !file.commit())
+    {
+        qDebug() << "could not write" << path << "into the tts cache:" << file.errorString();
+        return QString();
+    }
+
+    qint64 size = audio.size();
+    auto it = m_entries.find(key);
+    if (it != m_entries.end())
+    {
+        m_size -= it->size;
+    }
+    m_entries.insert(key, Entry{size, ++m_clock});
+    m_size += size;
+    evict(key);
+
+    /* Written now so a crash does not leave clips the index does not know about */
+    writeIndex();
+    return path;
+}
+
+void TtsCache::evict(const QByteArray &keep)
+{
+    if (m_size <= m_maxSize)
+    {
+        return;
+    }
+
+    QVector<QPair<quint64, QByteArray>> byAge;
+    byAge.reserve(m_entries.size());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it)
+    {
+        if (it.key() != keep)
+        {
+            byAge.append({it->lastUsed, it.key()});
+        }
+    }
+    std::sort(byAge.begin(), byAge.end());
+
+    for (const QPair<quint64, QByteArray> &old : byAge)
+    {
+        if (m_size <= m_maxSize)
+        {
+            break;
+        }
+        QFile::remove(filePath(old.second));
+        m_size -= m_entries.value(old.second).size;
+        m_entries.remove(old.second);
+    }
+    m_dirty = true;
+}
+
+void TtsCache::clear()
+{
+    QMutexLocker locker(&m_lock);
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it)
+    {
+        QFile::remove(filePath(it.key()));
+    }
+    m_entries.clear();
+    m_size = 0;
+    writeIndex();
+}
+
+void TtsCache::save()
+{
+    QMutexLocker locker(&m_lock);
+    if (m_dirty)
+    {
+        writeIndex();
+    }
+}
+
+QJsonObject TtsCache::memoryUsage()
+{
+    QMutexLocker locker(&m_lock);
+    qint64 heap = (qint64) m_entries.capacity() * sizeof(void *);
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it)
+    {
+        heap += sizeof(QHashNode<QByteArray, Entry>) + MemoryUtils::heapSize(it.key());
+    }
+    return QJsonObject{
+        {"files", m_entries.size()},
+        {"disk", m_size},
+        {"heap", heap}
+    };
+}
+
+/* index: u32 magic, u32 version, u64 clock, u32 count, then per clip the key, i64 size and u64 last use */
+bool TtsCache::readIndex()
+{
+    QFile file(m_dir + INDEX_FILE);
+    if (!file.open(QFile::ReadOnly))
+    {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic, version, count;
+    in >> magic >> version >> m_clock >> count;
+    if (in.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION)
+    {
+        qDebug() << "tts cache index is unreadable, rebuilding it";
+        return false;
+    }
+
+    m_entries.reserve(count);
+    for (quint32 i = 0; i < count; ++i)
+    {
+        QByteArray key;
+        Entry entry;
+        in >> key >> entry.size >> entry.lastUsed;
+        if (in.status() != QDataStream::Ok)
+        {
+            qDebug() << "tts cache index is truncated, rebuilding it";
+            m_entries.clear();
+            m_size = 0;
+            return false;
+        }
+        m_entries.insert(key, entry);
+        m_size += entry.size;
+    }
+    return true;
+}
+
+void TtsCache::rebuildIndex()
+{
+    m_entries.clear();
+    m_size = 0;
+    m_clock = 0;
+
+    /* Modification time is the best guess at use order that is left */
+    QFileInfoList clips = QDir(m_dir).entryInfoList({"*" CLIP_SUFFIX}, QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QFileInfo &clip : clips)
+    {
+        m_entries.insert(clip.completeBaseName().toLatin1(), Entry{clip.size(), ++m_clock});
+        m_size += clip.size();
+    }
+    evict(QByteArray());
+    writeIndex();
+}
+
+void TtsCache::writeIndex()
+{
+    QSaveFile file(m_dir + INDEX_FILE);
+    if (!file.open(QFile::WriteOnly))
+    {
+        qDebug() << "could not write tts cache index" << file.errorString();
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+
+    out << (quint32) INDEX_MAGIC << (quint32) INDEX_VERSION << m_clock << (quint32) m_entries.size();
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it)
+    {
+        out << it.key() << it->size << it->lastUsed;
+    }
+    if (!file.commit())
+    {
+        qDebug() << "could not write tts cache index" << file.errorString();
+        return;
+    }
+    m_dirty = false;
+}
@@ -0,0 +1,76 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef TTSCACHE_H
+#define TTSCACHE_H
+
+#include "ttsbackend.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+
+/**
+ * Synthesized speech kept on disk across sessions. Clips are named by a hash of what was synthesized,
+ * an index file keeps their sizes and last use so the least recently used are removed over the size cap.
+ * Thread safe.
+ */
+class TtsCache
+{
+public:
+    /* Loads the index from dirName, rebuilding it from the clips there if it is missing or unreadable */
+    TtsCache(const QString &dirName, qint64 maxSize);
+    ~TtsCache();
+
+    /* Content hash a clip is stored under, slow sources share the clip of the normal one */
+    static QByteArray key(const QString &text, const AudioSource &source, const QString &context);
+
+    /* Path of the clip and marks it as used, empty if it is not cached */
+    QString lookup(const QByteArray &key);
+
+    /* If the clip is cached, without marking it as used */
+    bool contains(const QByteArray &key);
+
+    /**
+     * Writes a clip into the cache, then evicts the least recently used clips over the size cap.
+     * The clip is written to a temporary file that replaces it once complete, so it is never seen half written.
+     * @return path of the clip, empty if it could not be written
+     */
+    QString insert(const QByteArray &key, const QByteArray &audio);
+
+    /* Removes every clip */
+    void clear();
+
+    /* Writes the index if it changed since it was last written */
+    void save();
+
+    /* Number of clips, their size on disk and the heap used to track them */
+    QJsonObject memoryUsage();
+
+private:
+    struct Entry
+    {
+        qint64 size;
+        /* Value of m_clock when it was last used, larger is more recent */
+        quint64 lastUsed;
+    };
+
+    QString filePath(const QByteArray &key) const;
+    bool readIndex();
+    void rebuildIndex();
+    void writeIndex();
+    void evict(const QByteArray &keep);
+
+    QString m_dir;
+    qint64 m_maxSize;
+    qint64 m_size;
+    quint64 m_clock;
+    bool m_dirty;
+    QHash<QByteArray, Entry> m_entries;
+    QMutex m_lock;
+};
+
+#endif // TTSCACHE_H
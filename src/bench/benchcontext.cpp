@@ -0,0 +1,81 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "benchcontext.h"
+#include "../dict/dictionary.h"
+#include "../dict/frenchprocessor.h"
+#include "../util/directoryutils.h"
+#include "../util/globalmediator.h"
+
+#include <QFile>
+#include <QRegularExpression>
+#include <QSet>
+#include <QTextStream>
+#include <stdexcept>
+
+BenchContext::BenchContext() : dictionaryFilename(DirectoryUtils::getDictionaryFile()),
+                               layersDir(DirectoryUtils::getDictionaryLayersDir()), corpusFilename(BENCH_CORPUS) {}
+
+BenchContext &BenchContext::instance() {
+    static BenchContext context;
+    return context;
+}
+
+void BenchContext::setDictionaryFile(const QString &filename) {
+    this->dictionaryFilename = filename;
+}
+
+void BenchContext::setLayersDir(const QString &dir) {
+    this->layersDir = dir;
+}
+
+void BenchContext::setCorpusFile(const QString &filename) {
+    this->corpusFilename = filename;
+}
+
+const QString &BenchContext::dictionaryFile() const {
+    return this->dictionaryFilename;
+}
+
+std::shared_ptr<Dictionary> BenchContext::dictionary() {
+    if (!this->loadedDictionary) {
+        this->loadedDictionary = std::make_shared<Dictionary>(this->dictionaryFilename, this->layersDir);
+        GlobalMediator::getGlobalMediator()->setDictionary(this->loadedDictionary);
+    }
+    return this->loadedDictionary;
+}
+
+const QStringList &BenchContext::corpus() {
+    if (this->lines.isEmpty()) {
+        QFile file(this->corpusFilename);
+        if (!file.open(QFile::ReadOnly | QFile::Text)) {
+            throw std::runtime_error("failed to open corpus " + this->corpusFilename.toStdString());
+        }
+        QTextStream stream(&file);
+        stream.setCodec("UTF-8");
+        while (!stream.atEnd()) {
+            QString line = stream.readLine().trimmed();
+            if (!line.isEmpty()) {
+                this->lines.append(line);
+            }
+        }
+    }
+    return this->lines;
+}
+
+const QStringList &BenchContext::corpusWords() {
+    if (this->words.isEmpty()) {
+        QSet<QString> seen;
+        for (const QString &line : this->corpus()) {
+            for (const QString &word : line.split(QRegularExpression("[^\\w'-]+"), QString::SkipEmptyParts)) {
+                QString clean = FrenchProcessor::cleanWord(word);
+                if (!seen.contains(clean)) {
+                    seen.insert(clean);
+                    this->words.append(clean);
+                }
+            }
+        }
+    }
+    return this->words;
+}
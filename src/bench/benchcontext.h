@@ -0,0 +1,48 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_BENCHCONTEXT_H
+#define MEMENTO_BENCHCONTEXT_H
+
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+class Dictionary;
+
+/**
+ * What every benchmark shares: the files given on the command line, the dictionary they are run
+ * against and the subtitle corpus. Everything is loaded on first use so a filtered run only pays for what it needs.
+ */
+class BenchContext {
+
+public:
+    static BenchContext &instance();
+
+    void setDictionaryFile(const QString &filename);
+    void setLayersDir(const QString &dir);
+    void setCorpusFile(const QString &filename);
+
+    const QString &dictionaryFile() const;
+    /* Loaded once and published to the GlobalMediator, which is where FrenchProcessor gets it from */
+    std::shared_ptr<Dictionary> dictionary();
+    /* One subtitle per line */
+    const QStringList &corpus();
+    /* Distinct words of the corpus, cleaned the way subtitle words are before a lookup */
+    const QStringList &corpusWords();
+
+private:
+    BenchContext();
+
+    QString dictionaryFilename;
+    QString layersDir;
+    QString corpusFilename;
+    std::shared_ptr<Dictionary> loadedDictionary;
+    QStringList lines;
+    QStringList words;
+
+};
+
+
+#endif //MEMENTO_BENCHCONTEXT_H
@@ -0,0 +1,125 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "benchcontext.h"
+#include "../dict/dictionary.h"
+#include "../dict/dictionarylayer.h"
+#include "../dict/frenchprocessor.h"
+#include "../util/memoryutils.h"
+
+#include <benchmark/benchmark.h>
+
+/* Registered first so that the peak resident set it reports is mostly the load itself */
+static void BM_LoadDictionary(benchmark::State &state) {
+    // a layer is the mapped file, DictReader::readIntoDictionary and the filters built over its keys
+    quint32 numEntries = 0;
+    for (auto _ : state) {
+        DictionaryLayer layer(BenchContext::instance().dictionaryFile());
+        numEntries = layer.numEntries();
+        benchmark::DoNotOptimize(numEntries);
+    }
+    state.counters["entries"] = numEntries;
+    state.counters["peak_rss_bytes"] = MemoryUtils::getPeakResidentSetSize();
+}
+BENCHMARK(BM_LoadDictionary)->Unit(benchmark::kMillisecond);
+
+static void BM_LookupHit(benchmark::State &state) {
+    std::shared_ptr<Dictionary> dictionary = BenchContext::instance().dictionary();
+    QStringList hits;
+    for (const QString &word : BenchContext::instance().corpusWords()) {
+        if (dictionary->lookup(word) != nullptr) {
+            hits.append(word);
+        }
+    }
+    if (hits.isEmpty()) {
+        state.SkipWithError("no corpus word is a headword");
+        return;
+    }
+
+    int i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dictionary->lookup(hits[i]));
+        if (++i == hits.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["words"] = hits.size();
+}
+BENCHMARK(BM_LookupHit);
+
+static void BM_LookupMiss(benchmark::State &state) {
+    // most lookups FrenchProcessor makes are word groups that are not headwords
+    std::shared_ptr<Dictionary> dictionary = BenchContext::instance().dictionary();
+    const QStringList &words = BenchContext::instance().corpusWords();
+    QStringList misses;
+    for (int i = 0; i + 1 < words.size(); i++) {
+        QString group = words[i] + ' ' + words[i + 1];
+        if (dictionary->lookup(group) == nullptr) {
+            misses.append(group);
+        }
+    }
+    if (misses.isEmpty()) {
+        state.SkipWithError("every word group of the corpus is a headword");
+        return;
+    }
+
+    int i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dictionary->lookup(misses[i]));
+        if (++i == misses.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["words"] = misses.size();
+}
+BENCHMARK(BM_LookupMiss);
+
+static void BM_ProcessSubtitle(benchmark::State &state) {
+    BenchContext::instance().dictionary();
+    const QStringList &lines = BenchContext::instance().corpus();
+    FrenchProcessor processor;
+    for (auto _ : state) {
+        for (const QString &line : lines) {
+            benchmark::DoNotOptimize(processor.processSubtitle(line));
+        }
+    }
+    // items per second is subtitle lines per second
+    state.SetItemsProcessed(state.iterations() * lines.size());
+    state.counters["lines"] = lines.size();
+}
+BENCHMARK(BM_ProcessSubtitle)->Unit(benchmark::kMillisecond);
+
+static void BM_SpellingSuggestions(benchmark::State &state) {
+    // headwords of the corpus with a letter dropped, the typo a spelling suggestion has to fix
+    std::shared_ptr<Dictionary> dictionary = BenchContext::instance().dictionary();
+    QStringList typos;
+    for (const QString &word : BenchContext::instance().corpusWords()) {
+        if (word.size() < 4 || dictionary->lookup(word) == nullptr) {
+            continue;
+        }
+        QString typo = QString(word).remove(word.size() / 2, 1);
+        if (dictionary->lookup(typo) == nullptr) {
+            typos.append(typo);
+        }
+    }
+    if (typos.isEmpty()) {
+        state.SkipWithError("no typos could be made from the corpus");
+        return;
+    }
+    // the first query maps the spelling index
+    dictionary->suggest(typos.first(), 2, 5);
+
+    int i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dictionary->suggest(typos[i], 2, 5));
+        if (++i == typos.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["words"] = typos.size();
+}
+BENCHMARK(BM_SpellingSuggestions)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,60 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "benchcontext.h"
+#include "../util/globalmediator.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <vector>
+
+static void printUsage()
+{
+    qInfo().noquote() << "memento-bench [benchmark options] [--dictionary=FILE] [--layers=DIR] [--corpus=FILE]\n"
+                         "  --dictionary  base dictionary, defaults to the one in the config directory\n"
+                         "  --layers      directory of dictionary layers, defaults to the one in the config directory\n"
+                         "  --corpus      French subtitles, one per line, defaults to the bundled corpus\n"
+                         "Results are printed as JSON unless --benchmark_format is given.";
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    // JSON by default so results can be kept and compared between releases
+    std::vector<char *> args(argv, argv + argc);
+    bool formatGiven = false;
+    for (char *arg : args) {
+        formatGiven |= strncmp(arg, "--benchmark_format", 18) == 0;
+    }
+    static char jsonFormat[] = "--benchmark_format=json";
+    if (!formatGiven) {
+        args.insert(args.begin() + 1, jsonFormat);
+    }
+    int numArgs = args.size();
+    benchmark::Initialize(&numArgs, args.data());
+
+    // benchmark::Initialize leaves the arguments it does not know
+    BenchContext &context = BenchContext::instance();
+    for (int i = 1; i < numArgs; i++) {
+        QString arg = QString::fromLocal8Bit(args[i]);
+        if (arg.startsWith("--dictionary=")) {
+            context.setDictionaryFile(arg.mid(strlen("--dictionary=")));
+        } else if (arg.startsWith("--layers=")) {
+            context.setLayersDir(arg.mid(strlen("--layers=")));
+        } else if (arg.startsWith("--corpus=")) {
+            context.setCorpusFile(arg.mid(strlen("--corpus=")));
+        } else {
+            qCritical() << "unknown argument" << arg;
+            printUsage();
+            return 1;
+        }
+    }
+
+    GlobalMediator::createGlobalMedaitor();
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -0,0 +1,61 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "bloomfilter.h"
+#include "perfecthash.h"
+
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cmath>
+
+BloomFilter::BloomFilter() : numBits(0), numHashes(0) {}
+
+void BloomFilter::reset(const quint32 numItems, const int bitsPerItem) {
+    quint64 numWords = std::max<quint64>(1, ((quint64) numItems * bitsPerItem + 63) / 64);
+    this->words = QVector<quint64>(numWords, 0);
+    this->numBits = numWords * 64;
+    // optimal number of hashes is bits per item * ln 2
+    this->numHashes = std::max(1, (int) std::lround(bitsPerItem * 0.693));
+}
+
+quint64 BloomFilter::bitIndex(const quint64 hash, const int i) const {
+    // double hashing, the second hash is odd so it never degenerates to a single bit
+    quint64 step = PerfectHash::mix(hash) | 1;
+    return (hash + i * step) % this->numBits;
+}
+
+void BloomFilter::insert(const quint64 hash) {
+    for (int i = 0; i < this->numHashes; i++) {
+        quint64 bit = this->bitIndex(hash, i);
+        this->words[bit / 64] |= (quint64) 1 << (bit % 64);
+    }
+}
+
+quint64 BloomFilter::sizeInBits() const {
+    return this->numBits;
+}
+
+double BloomFilter::estimatedFalsePositiveRate() const {
+    if (this->numBits == 0) {
+        return 0;
+    }
+    quint64 setBits = 0;
+    for (quint64 word : this->words) {
+        setBits += qPopulationCount(word);
+    }
+    return std::pow((double) setBits / this->numBits, this->numHashes);
+}
+
+bool BloomFilter::mightContain(const quint64 hash) const {
+    if (this->numBits == 0) {
+        return false;
+    }
+    for (int i = 0; i < this->numHashes; i++) {
+        quint64 bit = this->bitIndex(hash, i);
+        if (!(this->words[bit / 64] & ((quint64) 1 << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
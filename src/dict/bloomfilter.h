@@ -0,0 +1,38 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_BLOOMFILTER_H
+#define MEMENTO_BLOOMFILTER_H
+
+#include <QVector>
+
+/**
+ * Bloom filter over 64 bit hashes, built when a dictionary is loaded.
+ * Lets a lookup skip a dictionary that definitely does not have the key.
+ */
+class BloomFilter {
+
+public:
+    BloomFilter();
+
+    /* Clear the filter and size it for numItems, about 1% false positives at 10 bits per item */
+    void reset(quint32 numItems, int bitsPerItem);
+    void insert(quint64 hash);
+    bool mightContain(quint64 hash) const;
+
+    quint64 sizeInBits() const;
+    /* Chance that an item that was never inserted passes, from how many bits are set */
+    double estimatedFalsePositiveRate() const;
+
+private:
+    quint64 bitIndex(quint64 hash, int i) const;
+
+    QVector<quint64> words;
+    quint64 numBits;
+    int numHashes;
+
+};
+
+
+#endif //MEMENTO_BLOOMFILTER_H
@@ -0,0 +1,53 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "crc32c.h"
+
+#include <array>
+
+/* Reversed Castagnoli polynomial */
+static const quint32 POLYNOMIAL = 0x82f63b78;
+
+using Tables = std::array<std::array<quint32, 256>, 8>;
+
+static Tables makeTables() {
+    Tables tables{};
+    for (quint32 i = 0; i < 256; i++) {
+        quint32 crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 1 ? (crc >> 1) ^ POLYNOMIAL : crc >> 1;
+        }
+        tables[0][i] = crc;
+    }
+    // tables[k][i] is the crc of byte i followed by k zero bytes
+    for (quint32 i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xff];
+        }
+    }
+    return tables;
+}
+
+static const Tables TABLES = makeTables();
+
+quint32 Crc32c::update(quint32 crc, const uchar *data, qint64 len) {
+    crc = ~crc;
+    while (len >= 8) {
+        quint32 low = crc ^ ((quint32) data[0] | (quint32) data[1] << 8 | (quint32) data[2] << 16 | (quint32) data[3] << 24);
+        crc = TABLES[7][low & 0xff] ^ TABLES[6][(low >> 8) & 0xff] ^ TABLES[5][(low >> 16) & 0xff] ^ TABLES[4][low >> 24] ^
+              TABLES[3][data[4]] ^ TABLES[2][data[5]] ^ TABLES[1][data[6]] ^ TABLES[0][data[7]];
+        data += 8;
+        len -= 8;
+    }
+    while (len > 0) {
+        crc = (crc >> 8) ^ TABLES[0][(crc ^ *data) & 0xff];
+        data++;
+        len--;
+    }
+    return ~crc;
+}
+
+quint32 Crc32c::update(const quint32 crc, const QByteArray &data) {
+    return update(crc, (const uchar *) data.constData(), data.size());
+}
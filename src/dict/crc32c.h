@@ -0,0 +1,25 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_CRC32C_H
+#define MEMENTO_CRC32C_H
+
+#include <QByteArray>
+
+/**
+ * CRC-32C (Castagnoli), the checksum of each section of a dictionary file.
+ * Table driven eight bytes at a time. The definition blocks, most of a file, are checked one by one as they are
+ * first read, the other sections when the dictionary loads.
+ */
+class Crc32c {
+
+public:
+    /* Continue crc over more data, start with 0 */
+    static quint32 update(quint32 crc, const uchar *data, qint64 len);
+    static quint32 update(quint32 crc, const QByteArray &data);
+
+};
+
+
+#endif //MEMENTO_CRC32C_H
@@ -0,0 +1,347 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "dawg.h"
+#include "dictwriter.h"
+
+#include <QtEndian>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// node: u8 flags, u8 number of transitions, transitions sorted by label
+// transition: u8 label, u32 target node offset, u32 number of keys that sort before it
+static const quint32 NODE_HEADER_SIZE = 2;
+static const quint32 TRANSITION_SIZE = 9;
+static const quint8 NODE_FINAL = 0x01;
+
+Dawg::Dawg() : nodes(nullptr), nodesSize(0), rankToEntry(nullptr), numKeys(0) {}
+
+namespace {
+
+struct BuildNode {
+    bool final = false;
+    /* Sorted by label, keys are inserted in order */
+    std::vector<std::pair<uchar, quint32>> edges;
+    quint32 count = 0;
+    quint32 offset = 0;
+};
+
+class DawgBuilder {
+
+public:
+    quint32 newNode() {
+        if (!this->freeNodes.empty()) {
+            quint32 node = this->freeNodes.back();
+            this->freeNodes.pop_back();
+            this->nodes[node] = BuildNode();
+            return node;
+        }
+        this->nodes.emplace_back();
+        return this->nodes.size() - 1;
+    }
+
+    /* Merge the nodes along the previous key below depth downTo into equivalent registered nodes */
+    void minimize(const size_t downTo) {
+        while (this->unchecked.size() > downTo) {
+            auto [parent, child] = this->unchecked.back();
+            this->unchecked.pop_back();
+            std::string signature = this->signature(child);
+            auto existing = this->registered.find(signature);
+            if (existing != this->registered.end()) {
+                // the edge to child is the last one added to parent
+                this->nodes[parent].edges.back().second = existing->second;
+                this->freeNodes.push_back(child);
+            } else {
+                this->registered.emplace(std::move(signature), child);
+            }
+        }
+    }
+
+    std::string signature(const quint32 node) const {
+        const BuildNode &n = this->nodes[node];
+        std::string out(1, n.final ? '\1' : '\0');
+        for (const auto &[label, child] : n.edges) {
+            out.push_back(label);
+            out.append((const char *) &child, sizeof(child));
+        }
+        return out;
+    }
+
+    quint32 count(const quint32 node, std::vector<bool> &counted) {
+        if (!counted[node]) {
+            quint32 total = this->nodes[node].final ? 1 : 0;
+            for (const auto &edge : this->nodes[node].edges) {
+                total += this->count(edge.second, counted);
+            }
+            this->nodes[node].count = total;
+            counted[node] = true;
+        }
+        return this->nodes[node].count;
+    }
+
+    std::vector<BuildNode> nodes;
+    std::vector<quint32> freeNodes;
+    std::vector<std::pair<quint32, quint32>> unchecked; // (parent, child) along the previous key
+    std::unordered_map<std::string, quint32> registered;
+
+};
+
+}
+
+QByteArray Dawg::build(const QVector<QByteArray> &sortedKeys, const QVector<quint32> &rankToEntry) {
+    DawgBuilder builder;
+    quint32 root = builder.newNode();
+    QByteArray previous;
+    for (const QByteArray &key : sortedKeys) {
+        int common = 0;
+        while (common < std::min(key.size(), previous.size()) && key[common] == previous[common]) {
+            common++;
+        }
+        builder.minimize(common);
+
+        quint32 node = builder.unchecked.empty() ? root : builder.unchecked.back().second;
+        for (int i = common; i < key.size(); i++) {
+            quint32 child = builder.newNode();
+            builder.nodes[node].edges.emplace_back((uchar) key[i], child);
+            builder.unchecked.emplace_back(node, child);
+            node = child;
+        }
+        builder.nodes[node].final = true;
+        previous = key;
+    }
+    builder.minimize(0);
+    builder.registered.clear();
+
+    // lay the nodes out breadth first so the root is at offset 0
+    std::vector<quint32> order{root};
+    std::vector<bool> seen(builder.nodes.size(), false);
+    seen[root] = true;
+    for (size_t i = 0; i < order.size(); i++) {
+        for (const auto &edge : builder.nodes[order[i]].edges) {
+            if (!seen[edge.second]) {
+                seen[edge.second] = true;
+                order.push_back(edge.second);
+            }
+        }
+    }
+
+    std::vector<bool> counted(builder.nodes.size(), false);
+    builder.count(root, counted);
+
+    quint32 offset = 0;
+    for (quint32 node : order) {
+        if (builder.nodes[node].edges.size() > 255) {
+            throw std::runtime_error("too many transitions from one automaton node");
+        }
+        builder.nodes[node].offset = offset;
+        offset += NODE_HEADER_SIZE + TRANSITION_SIZE * builder.nodes[node].edges.size();
+    }
+
+    QByteArray out;
+    DictWriter::appendUInt32(out, offset);
+    for (quint32 node : order) {
+        const BuildNode &n = builder.nodes[node];
+        DictWriter::appendUInt8(out, n.final ? NODE_FINAL : 0);
+        DictWriter::appendUInt8(out, n.edges.size());
+        quint32 countBefore = n.final ? 1 : 0;
+        for (const auto &[label, child] : n.edges) {
+            DictWriter::appendUInt8(out, label);
+            DictWriter::appendUInt32(out, builder.nodes[child].offset);
+            DictWriter::appendUInt32(out, countBefore);
+            countBefore += builder.nodes[child].count;
+        }
+    }
+    for (quint32 entryId : rankToEntry) {
+        DictWriter::appendUInt32(out, entryId);
+    }
+    return out;
+}
+
+qint64 Dawg::load(const uchar *data, const qint64 size, const quint32 numKeys) {
+    if (size < 4) {
+        throw std::runtime_error("key automaton extends past end of file");
+    }
+    this->nodesSize = qFromLittleEndian<quint32>(data);
+    this->numKeys = numKeys;
+    qint64 sectionSize = 4 + (qint64) this->nodesSize + (qint64) numKeys * 4;
+    if (sectionSize > size || this->nodesSize < NODE_HEADER_SIZE) {
+        throw std::runtime_error("key automaton extends past end of file");
+    }
+    this->nodes = data + 4;
+    this->rankToEntry = this->nodes + this->nodesSize;
+    return sectionSize;
+}
+
+quint8 Dawg::numTransitions(const quint32 node) const {
+    return this->nodes[node + 1];
+}
+
+bool Dawg::isFinalNode(const quint32 node) const {
+    return this->nodes[node] & NODE_FINAL;
+}
+
+const uchar *Dawg::transitionAt(const quint32 node, const int index) const {
+    quint32 offset = node + NODE_HEADER_SIZE + index * TRANSITION_SIZE;
+    if (offset + TRANSITION_SIZE > this->nodesSize) {
+        throw std::runtime_error("key automaton transition out of bounds");
+    }
+    return this->nodes + offset;
+}
+
+bool Dawg::findTransition(const quint32 node, const uchar label, quint32 &target, quint32 &countBefore) const {
+    int low = 0;
+    int high = this->numTransitions(node);
+    while (low < high) {
+        int mid = (low + high) / 2;
+        const uchar *transition = this->transitionAt(node, mid);
+        if (transition[0] < label) {
+            low = mid + 1;
+        } else if (transition[0] > label) {
+            high = mid;
+        } else {
+            target = qFromLittleEndian<quint32>(transition + 1);
+            countBefore = qFromLittleEndian<quint32>(transition + 5);
+            return target + NODE_HEADER_SIZE <= this->nodesSize;
+        }
+    }
+    return false;
+}
+
+Dawg::State Dawg::root() const {
+    return State{0, 0};
+}
+
+bool Dawg::step(State &state, const QByteArray &bytes) const {
+    State next = state;
+    for (char c : bytes) {
+        quint32 target;
+        quint32 countBefore;
+        if (!this->findTransition(next.node, c, target, countBefore)) {
+            return false;
+        }
+        next.node = target;
+        next.rank += countBefore;
+    }
+    state = next;
+    return true;
+}
+
+bool Dawg::isFinal(const State &state) const {
+    return this->isFinalNode(state.node);
+}
+
+quint32 Dawg::entryId(const State &state) const {
+    if (state.rank >= this->numKeys) {
+        throw std::runtime_error("key automaton rank out of bounds");
+    }
+    return qFromLittleEndian<quint32>(this->rankToEntry + state.rank * 4);
+}
+
+qint64 Dawg::find(const QByteArray &key) const {
+    State state = this->root();
+    if (!this->step(state, key) || !this->isFinal(state)) {
+        return -1;
+    }
+    return this->entryId(state);
+}
+
+QVector<DawgMatch> Dawg::prefixMatches(const QByteArray &prefix, const int limit) const {
+    QVector<DawgMatch> out;
+    State state = this->root();
+    if (limit > 0 && this->step(state, prefix)) {
+        QByteArray key = prefix;
+        this->collect(state.node, state.rank, key, limit, out);
+    }
+    return out;
+}
+
+void Dawg::collect(const quint32 node, const quint32 rank, QByteArray &key, const int limit, QVector<DawgMatch> &out) const {
+    if (this->isFinalNode(node)) {
+        out.append(DawgMatch{key, this->entryId(State{node, rank}), 0});
+    }
+
+    int numTransitions = this->numTransitions(node);
+    for (int i = 0; i < numTransitions && out.size() < limit; i++) {
+        const uchar *transition = this->transitionAt(node, i);
+        key.append((char) transition[0]);
+        this->collect(qFromLittleEndian<quint32>(transition + 1), rank + qFromLittleEndian<quint32>(transition + 5), key, limit, out);
+        key.chop(1);
+    }
+}
+
+QVector<DawgMatch> Dawg::fuzzyMatches(const QString &word, const int maxDistance, const int limit) const {
+    QVector<uint> target = word.toUcs4();
+    QVector<int> row(target.size() + 1);
+    for (int i = 0; i < row.size(); i++) {
+        row[i] = i;
+    }
+
+    // search one distance at a time so the closest keys fill the limit first
+    QVector<DawgMatch> out;
+    QByteArray key;
+    for (int distance = 0; distance <= maxDistance && out.size() < limit; distance++) {
+        this->collectFuzzy(0, 0, key, target, row, 0, 0, distance, limit, out);
+    }
+    return out;
+}
+
+void Dawg::collectFuzzy(const quint32 node, const quint32 rank, QByteArray &key,
+                        const QVector<uint> &target, const QVector<int> &row,
+                        const uint pendingCodePoint, const int pendingBytes,
+                        const int distance, const int limit, QVector<DawgMatch> &out) const {
+    if (pendingBytes == 0 && this->isFinalNode(node) && row.last() == distance) {
+        out.append(DawgMatch{key, this->entryId(State{node, rank}), distance});
+    }
+
+    int numTransitions = this->numTransitions(node);
+    for (int i = 0; i < numTransitions && out.size() < limit; i++) {
+        const uchar *transition = this->transitionAt(node, i);
+        uchar label = transition[0];
+        quint32 nextNode = qFromLittleEndian<quint32>(transition + 1);
+        quint32 nextRank = rank + qFromLittleEndian<quint32>(transition + 5);
+
+        // edit distance is counted in code points, so only advance the row once a code point is complete
+        uint codePoint;
+        int remaining;
+        if (pendingBytes > 0) {
+            codePoint = (pendingCodePoint << 6) | (label & 0x3f);
+            remaining = pendingBytes - 1;
+        } else if (label < 0x80) {
+            codePoint = label;
+            remaining = 0;
+        } else if ((label & 0xe0) == 0xc0) {
+            codePoint = label & 0x1f;
+            remaining = 1;
+        } else if ((label & 0xf0) == 0xe0) {
+            codePoint = label & 0x0f;
+            remaining = 2;
+        } else {
+            codePoint = label & 0x07;
+            remaining = 3;
+        }
+
+        key.append((char) label);
+        if (remaining > 0) {
+            this->collectFuzzy(nextNode, nextRank, key, target, row, codePoint, remaining, distance, limit, out);
+        } else {
+            QVector<int> nextRow(row.size());
+            nextRow[0] = row[0] + 1;
+            int rowMin = nextRow[0];
+            for (int j = 1; j < row.size(); j++) {
+                int substitution = row[j - 1] + (target[j - 1] == codePoint ? 0 : 1);
+                nextRow[j] = std::min({row[j] + 1, nextRow[j - 1] + 1, substitution});
+                rowMin = std::min(rowMin, nextRow[j]);
+            }
+            if (rowMin <= distance) {
+                this->collectFuzzy(nextNode, nextRank, key, target, nextRow, 0, 0, distance, limit, out);
+            }
+        }
+        key.chop(1);
+    }
+}
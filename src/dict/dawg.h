@@ -0,0 +1,84 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_DAWG_H
+#define MEMENTO_DAWG_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+struct DawgMatch {
+    QByteArray key;
+    quint32 entryId;
+    int distance;
+};
+
+/**
+ * Minimized automaton over the utf8 headwords, generated by memento-dictc.
+ * Each transition stores how many keys sort before it, so the sum along a path is the key's rank,
+ * which a table in the same section maps to the entry id.
+ * All queries walk the serialized nodes in the mapped dictionary file.
+ */
+class Dawg {
+
+public:
+    struct State {
+        quint32 node;
+        quint32 rank;
+    };
+
+    Dawg();
+
+    /**
+     * Point the automaton at its section of the mapped dictionary file
+     * @return number of bytes the section takes up
+     */
+    qint64 load(const uchar *data, qint64 size, quint32 numKeys);
+
+    /**
+     * Build the section that load reads (Daciuk et al. incremental minimization), used by memento-dictc
+     * @param sortedKeys keys in byte order
+     * @param rankToEntry entry id of each key
+     */
+    static QByteArray build(const QVector<QByteArray> &sortedKeys, const QVector<quint32> &rankToEntry);
+
+    State root() const;
+    /**
+     * Follow the transitions for bytes
+     * @return false if no key starts with the bytes read so far, the state is then left unchanged
+     */
+    bool step(State &state, const QByteArray &bytes) const;
+    bool isFinal(const State &state) const;
+    /* Only valid if the state is final */
+    quint32 entryId(const State &state) const;
+
+    /* @return entry id of the key, or -1 if it is not in the automaton */
+    qint64 find(const QByteArray &key) const;
+    /* Keys starting with prefix, in sorted order */
+    QVector<DawgMatch> prefixMatches(const QByteArray &prefix, int limit) const;
+    /* Keys within maxDistance edits (counted in code points) of word, closest first */
+    QVector<DawgMatch> fuzzyMatches(const QString &word, int maxDistance, int limit) const;
+
+private:
+    quint8 numTransitions(quint32 node) const;
+    bool isFinalNode(quint32 node) const;
+    const uchar *transitionAt(quint32 node, int index) const;
+    bool findTransition(quint32 node, uchar label, quint32 &target, quint32 &countBefore) const;
+
+    void collect(quint32 node, quint32 rank, QByteArray &key, int limit, QVector<DawgMatch> &out) const;
+    void collectFuzzy(quint32 node, quint32 rank, QByteArray &key,
+                      const QVector<uint> &target, const QVector<int> &row,
+                      uint pendingCodePoint, int pendingBytes,
+                      int distance, int limit, QVector<DawgMatch> &out) const;
+
+    const uchar *nodes;
+    quint32 nodesSize;
+    const uchar *rankToEntry;
+    quint32 numKeys;
+
+};
+
+
+#endif //MEMENTO_DAWG_H
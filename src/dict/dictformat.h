@@ -0,0 +1,64 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_DICTFORMAT_H
+#define MEMENTO_DICTFORMAT_H
+
+#include <QtGlobal>
+
+/*
+ * Layout of a dictionary file, shared by DictReader and DictWriter. All integers are little endian.
+ *
+ * header:    char[8] magic, u32 version, u32 feature flags, u32 number of sections,
+ *            u32 crc32c of the header (with this field zeroed) and the section directory
+ * directory: per section u32 id, u32 flags, u32 codec, u32 crc32c, u64 offset, u64 length
+ * sections:  each starts on an 8 byte boundary
+ *
+ * With DICT_FEATURE_BLOCK_CRC the definitions section starts with u32 number of blocks, then per block
+ * u32 compressed size, u32 size, u32 crc32c of the compressed block. Its directory checksum only covers
+ * that table, so the blocks can be checked when they are first decompressed instead of when the file loads.
+ *
+ * Files from before the header are one gzip stream, they are refused and have to be rebuilt.
+ */
+
+#define DICT_MAGIC              "MEMDICT"
+#define DICT_MAGIC_SIZE         8
+#define DICT_VERSION            2
+#define DICT_HEADER_SIZE        24
+#define DICT_SECTION_INFO_SIZE  32
+#define DICT_SECTION_ALIGNMENT  8
+
+/* Features change how sections are read, a reader refuses a file with a feature it does not know */
+#define DICT_FEATURE_PARADIGMS  0x1 // inflections are (lemma, paradigm) pairs
+#define DICT_FEATURE_BLOCK_CRC  0x2 // definition blocks carry their own checksums
+#define DICT_FEATURES_SUPPORTED (DICT_FEATURE_PARADIGMS | DICT_FEATURE_BLOCK_CRC)
+
+/* A reader that does not know a section refuses the file if it is required, otherwise it skips it */
+#define DICT_SECTION_REQUIRED   0x1
+
+enum DictSectionId {
+    DICT_SECTION_ENTRIES = 1,       // paradigm tables then entries, one zlib stream
+    DICT_SECTION_KEYS = 2,          // utf8 headwords in slot order
+    DICT_SECTION_PERFECT_HASH = 3,
+    DICT_SECTION_KEY_INDEX = 4,     // Dawg
+    DICT_SECTION_FOLD_INDEX = 5,    // optional
+    DICT_SECTION_GLOSS_INDEX = 6,   // optional
+    DICT_SECTION_DEFINITIONS = 7    // block table then zlib blocks
+};
+
+enum DictCodec {
+    DICT_CODEC_NONE = 0,
+    DICT_CODEC_ZLIB = 1
+};
+
+struct DictSectionInfo {
+    quint32 id;
+    quint32 flags;
+    quint32 codec;
+    quint32 crc;
+    quint64 offset;
+    quint64 length;
+};
+
+#endif //MEMENTO_DICTFORMAT_H
@@ -18,34 +18,242 @@
 //
 ////////////////////////////////////////////////////////////////////////////////
 
+
 #include "dictionary.h"
 
-#include <QApplication>
 #include <QDebug>
-#include <QSettings>
-#include <algorithm>
+#include <QDir>
 #include <QFile>
+#include <QJsonArray>
+#include <QSet>
+#include <algorithm>
+#include <tuple>
 
 #include "../util/directoryutils.h"
-#include "dictreader.h"
-#include "frenchprocessor.h"
+#include "../util/memoryutils.h"
+
+Dictionary::Dictionary() : Dictionary(DirectoryUtils::getDictionaryFile(), DirectoryUtils::getDictionaryLayersDir(),
+                                       DirectoryUtils::getDictionaryCopyDir()) {}
 
-Dictionary::Dictionary() {
-    this->loadDict(DirectoryUtils::getDictionaryFile());
-    this->loadCss(DirectoryUtils::getDictionaryCssFile());
+Dictionary::Dictionary(const QString &filename, const QString &layersDirName, const QString &copyDir) {
+    // extra layers are applied in name order, so a later name overrides an earlier one
+    QDir layersDir(layersDirName);
+    QStringList layerFiles = layersDir.entryList({"*.dict"}, QDir::Files, QDir::Name);
+    for (auto it = layerFiles.crbegin(); it != layerFiles.crend(); ++it) {
+        try {
+            this->m_layers.push_back(std::make_unique<DictionaryLayer>(layersDir.filePath(*it), copyDir));
+        } catch (std::exception &e) {
+            qDebug() << "skipping dictionary layer" << *it << ":" << e.what();
+        }
+    }
+    this->m_layers.push_back(std::make_unique<DictionaryLayer>(filename, copyDir));
+    this->loadCss(filename + ".css");
 }
 
 Dictionary::~Dictionary()
 {
-    for (QHash<QString, DictEntry*>::iterator pair = this->map.begin(); pair != this->map.end(); pair++) {
-        delete pair.value();
+}
+
+void Dictionary::removeStaleCopies() {
+    QDir copyDir(DirectoryUtils::getDictionaryCopyDir());
+    for (const QString &copy : copyDir.entryList(QDir::Files)) {
+        copyDir.remove(copy);
     }
 }
 
-void Dictionary::loadDict(const QString filename) {
-    qDebug() << "load dictionary from" << filename;
-    DictReader reader{filename};
-    reader.readIntoDictionary(this);
+DictEntry *Dictionary::lookup(const QString &word) {
+    QByteArray key = word.toUtf8();
+    quint64 hash = PerfectHash::hashKey(key);
+    for (const std::unique_ptr<DictionaryLayer> &layer : this->m_layers) {
+        DictEntry *entry = layer->lookup(key, hash);
+        if (entry != nullptr) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+QList<DictEntry *> Dictionary::lookupAll(const QString &word) {
+    QByteArray key = word.toUtf8();
+    quint64 hash = PerfectHash::hashKey(key);
+    QList<DictEntry *> out;
+    for (const std::unique_ptr<DictionaryLayer> &layer : this->m_layers) {
+        DictEntry *entry = layer->lookup(key, hash);
+        if (entry != nullptr) {
+            out.append(entry);
+        }
+    }
+    return out;
+}
+
+DictionaryLayer *Dictionary::layerOf(const DictEntry *entry) const {
+    for (const std::unique_ptr<DictionaryLayer> &layer : this->m_layers) {
+        if (layer->contains(entry)) {
+            return layer.get();
+        }
+    }
+    throw std::runtime_error("entry is not part of this dictionary");
+}
+
+QString Dictionary::key(const DictEntry *entry) const {
+    return this->layerOf(entry)->key(entry);
+}
+
+QList<SyntaxInfo> Dictionary::syntaxInfos(const DictEntry *entry) const {
+    return this->layerOf(entry)->syntaxInfos(entry);
+}
+
+QStringList Dictionary::definitions(const DictEntry *entry, bool *unavailable) {
+    DictionaryLayer *layer = this->layerOf(entry);
+    QStringList out;
+    for (const DefinitionRef &ref : entry->definitions) {
+        // blocks are only checked once they are read, a damaged one must not take the caller down
+        try {
+            out.append(layer->definition(ref));
+        } catch (std::exception &e) {
+            qDebug() << "definition unavailable in" << layer->fileName() << ":" << e.what();
+            if (unavailable != nullptr) {
+                *unavailable = true;
+            }
+        }
+    }
+    return out;
+}
+
+/* Keeps the first match of each key, which is from the highest layer when matches were added top down */
+static void removeShadowed(QList<DictionaryMatch> &matches) {
+    QSet<QString> seen;
+    auto end = std::remove_if(matches.begin(), matches.end(), [&seen](const DictionaryMatch &match) {
+        if (seen.contains(match.key)) {
+            return true;
+        }
+        seen.insert(match.key);
+        return false;
+    });
+    matches.erase(end, matches.end());
+}
+
+static void limitMatches(QList<DictionaryMatch> &matches, const int limit) {
+    if (limit > 0 && matches.size() > limit) {
+        matches.erase(matches.begin() + limit, matches.end());
+    }
+}
+
+QList<DictionaryMatch> Dictionary::complete(const QString &prefix, const int limit) {
+    QList<DictionaryMatch> matches;
+    for (const std::unique_ptr<DictionaryLayer> &layer : this->m_layers) {
+        matches.append(layer->complete(prefix, limit));
+    }
+    std::stable_sort(matches.begin(), matches.end(), [](const DictionaryMatch &a, const DictionaryMatch &b) {
+        return a.key.toUtf8() < b.key.toUtf8();
+    });
+    removeShadowed(matches);
+    limitMatches(matches, limit);
+    return matches;
+}
+
+QList<DictionaryMatch> Dictionary::fuzzy(const QString &word, const int maxDistance, const int limit) {
+    QList<DictionaryMatch> matches;
+    for (const std::unique_ptr<DictionaryLayer> &layer : this->m_layers) {
+        matches.append(layer->fuzzy(word, maxDistance, limit));
+    }
+    std::stable_sort(matches.begin(), matches.end(), [](const DictionaryMatch &a, const DictionaryMatch &b) {
+        return a.distance < b.distance;
+    });
+    removeShadowed(matches);
+    limitMatches(matches, limit);
+    return matches;
+}
+
+QList<DictEntry *> Dictionary::lookupFolded(const QString &word) {
+    QList<DictEntry *> out;
+    for (const std::unique_ptr<DictionaryLayer> &layer : this->m_layers) {
+        out.append(layer->lookupFolded(word));
+    }
+    return out;
+}
+
+QList<DictionaryMatch> Dictionary::suggest(const QString &word, const int maxDistance, const int limit) {
+    QList<DictionaryMatch> matches;
+    for (const std::unique_ptr<DictionaryLayer> &layer : this->m_layers) {
+        matches.append(layer->suggest(word, maxDistance));
+    }
+
+    // closest first, then entries that have definitions of their own
+    std::stable_sort(matches.begin(), matches.end(), [](const DictionaryMatch &a, const DictionaryMatch &b) {
+        bool aDefined = !a.entry->definitions.isEmpty();
+        bool bDefined = !b.entry->definitions.isEmpty();
+        return std::tie(a.distance, bDefined, a.key) < std::tie(b.distance, aDefined, b.key);
+    });
+    removeShadowed(matches);
+    limitMatches(matches, limit);
+    return matches;
+}
+
+QList<DictionaryMatch> Dictionary::reverseSearch(const QString &query, const int limit) {
+    QList<std::pair<double, DictionaryMatch>> scored;
+    for (const std::unique_ptr<DictionaryLayer> &layer : this->m_layers) {
+        for (const GlossMatch &match : layer->reverseSearch(query, limit)) {
+            DictEntry *entry = layer->entry(match.entryId);
+            scored.append({match.score, DictionaryMatch{layer->key(entry), entry, 0}});
+        }
+    }
+    std::stable_sort(scored.begin(), scored.end(), [](const auto &a, const auto &b) {
+        return a.first > b.first;
+    });
+
+    QList<DictionaryMatch> matches;
+    for (const auto &pair : scored) {
+        matches.append(pair.second);
+    }
+    removeShadowed(matches);
+    limitMatches(matches, limit);
+    return matches;
+}
+
+const std::vector<std::unique_ptr<DictionaryLayer>> &Dictionary::layers() const {
+    return this->m_layers;
+}
+
+QJsonObject Dictionary::diagnostics() const {
+    QJsonArray layers;
+    for (const std::unique_ptr<DictionaryLayer> &layer : this->m_layers) {
+        PhraseFilterStats stats = layer->phraseFilter().stats();
+        layers.append(QJsonObject{
+            {"file", layer->fileName()},
+            {"entries", (qint64) layer->numEntries()},
+            {"phraseFilter", QJsonObject{
+                {"phrases", (qint64) stats.phrases},
+                {"bits", (qint64) stats.bits},
+                {"estimatedFalsePositiveRate", stats.estimatedFalsePositiveRate},
+                {"checks", (qint64) stats.checks},
+                {"avoidedProbes", (qint64) stats.avoidedProbes},
+                {"falsePositives", (qint64) stats.falsePositives},
+                // share of the misses that still got through, a group that passed may also be a real headword start
+                {"observedFalsePositiveRate", stats.avoidedProbes + stats.falsePositives == 0 ? 0.0 :
+                    (double) stats.falsePositives / (stats.avoidedProbes + stats.falsePositives)}
+            }}
+        });
+    }
+    return QJsonObject{{"layers", layers}};
+}
+
+QJsonObject Dictionary::memoryUsage() const {
+    QJsonArray layers;
+    qint64 heap = MemoryUtils::heapSize(this->termCss);
+    qint64 mapped = 0;
+    for (const std::unique_ptr<DictionaryLayer> &layer : this->m_layers) {
+        QJsonObject usage = layer->memoryUsage();
+        heap += (qint64) usage["heap"].toDouble();
+        mapped += (qint64) usage["mapped"].toDouble();
+        layers.append(usage);
+    }
+    return QJsonObject{
+        {"heap", heap},
+        {"mapped", mapped},
+        {"css", MemoryUtils::heapSize(this->termCss)},
+        {"layers", layers}
+    };
 }
 
 void Dictionary::loadCss(const QString filename) {
@@ -55,4 +263,4 @@ void Dictionary::loadCss(const QString filename) {
         throw std::runtime_error("failed to open css file");
     }
     this->termCss = file.readAll();
-}
\ No newline at end of file
+}
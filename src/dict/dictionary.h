@@ -23,22 +23,67 @@
 
 #include <QString>
 #include <QList>
-#include <QThread>
-#include <QHash>
+#include <QStringList>
+#include <QJsonObject>
+#include <memory>
+#include <vector>
 #include "expression.h"
+#include "dictionarylayer.h"
 
+/**
+ * The base dictionary with user overrides and domain glossaries stacked on top of it.
+ * Every lookup probes each layer at most once, a layer's bloom filter skips most misses.
+ */
 class Dictionary
 {
 public:
+    /* The dictionary and layers in the config directory, mapped from private copies so they can be overwritten */
     Dictionary();
+    /**
+     * filename is the base dictionary, its css is filename + ".css" and layersDir holds the *.dict layers over it.
+     * With a copyDir the files are copied there and the copies mapped, see DictionaryLayer
+     */
+    Dictionary(const QString &filename, const QString &layersDir, const QString &copyDir = QString());
     ~Dictionary();
 
-    QHash<QString,DictEntry*> map;
+    /* Removes copies left in the copy directory by a run that did not exit cleanly, call before any Dictionary is made */
+    static void removeStaleCopies();
+
+    /* Entry from the highest layer that has word */
+    DictEntry *lookup(const QString &word);
+    /* Entries for word from every layer, highest first */
+    QList<DictEntry *> lookupAll(const QString &word);
+    QString key(const DictEntry *entry) const;
+    /* Part of speech, lemma and tags of each way entry inflects a lemma, generated from its paradigms */
+    QList<SyntaxInfo> syntaxInfos(const DictEntry *entry) const;
+    /* Definitions that could be read, unavailable is set when a block of the file is missing or corrupt */
+    QStringList definitions(const DictEntry *entry, bool *unavailable = nullptr);
+    /* Headwords starting with prefix, in sorted order */
+    QList<DictionaryMatch> complete(const QString &prefix, int limit);
+    /* Headwords within maxDistance edits of word, closest first */
+    QList<DictionaryMatch> fuzzy(const QString &word, int maxDistance, int limit);
+    /* Entries whose headword matches word once accents are ignored, best guess first */
+    QList<DictEntry *> lookupFolded(const QString &word);
+    /* Spelling corrections for a word that has no entry, closest first. Loads the spelling indexes on first use */
+    QList<DictionaryMatch> suggest(const QString &word, int maxDistance, int limit);
+    /* French headwords whose English translations match query, best match first */
+    QList<DictionaryMatch> reverseSearch(const QString &query, int limit);
+
+    /* Layers from highest priority to the base dictionary */
+    const std::vector<std::unique_ptr<DictionaryLayer>> &layers() const;
+
+    /* Sizes and filter counters of each layer, shown from the Dictionary menu */
+    QJsonObject diagnostics() const;
+    /* Bytes by category for each layer, see DictionaryLayer::memoryUsage */
+    QJsonObject memoryUsage() const;
+
     QString termCss;
 
 private:
-    void loadDict(QString filename);
     void loadCss(QString filename);
+    DictionaryLayer *layerOf(const DictEntry *entry) const;
+
+    std::vector<std::unique_ptr<DictionaryLayer>> m_layers;
 
 };
 
@@ -0,0 +1,365 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "dictionarylayer.h"
+#include "dictreader.h"
+#include "dictformat.h"
+#include "crc32c.h"
+#include "../util/memoryutils.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QtEndian>
+#include <zlib.h>
+
+/* Upper bound on the bytes of decompressed definition blocks kept around, per layer */
+static const int BLOCK_CACHE_SIZE = 1024 * 1024;
+/* About 1% of misses get past the bloom filter */
+static const int BLOOM_BITS_PER_KEY = 10;
+/* Bytes copied at a time into a private copy */
+static const qint64 COPY_CHUNK_SIZE = 1024 * 1024;
+
+/* Copy from into a new temporary file in dir */
+static void copyToTemporary(const QString &from, const QString &dir, QTemporaryFile &to) {
+    QFile source(from);
+    if (!source.open(QFile::ReadOnly)) {
+        throw std::runtime_error("failed to open dictionary file " + from.toStdString());
+    }
+    to.setFileTemplate(QDir(dir).filePath(QFileInfo(from).fileName() + ".XXXXXX"));
+    if (!to.open()) {
+        throw std::runtime_error("failed to create a copy of " + from.toStdString() + " in " + dir.toStdString());
+    }
+    while (!source.atEnd()) {
+        QByteArray chunk = source.read(COPY_CHUNK_SIZE);
+        if (chunk.isEmpty() || to.write(chunk) != chunk.size()) {
+            throw std::runtime_error("failed to copy " + from.toStdString());
+        }
+    }
+    if (!to.flush()) {
+        throw std::runtime_error("failed to copy " + from.toStdString());
+    }
+}
+
+DictionaryLayer::DictionaryLayer(const QString &filename, const QString &copyDir) : filename(filename),
+                                                           spellingFile(filename + ".spell"), data(nullptr), size(0), keyOffsets(nullptr),
+                                                           keys(nullptr), spellingAttempted(false), blockCache(BLOCK_CACHE_SIZE) {
+    qDebug() << "load dictionary from" << filename;
+    this->file.setFileName(filename);
+    if (!copyDir.isEmpty()) {
+        // a file copied over in place would change under the mapping, which can end in SIGBUS
+        QDir().mkpath(copyDir);
+        copyToTemporary(filename, copyDir, this->copy);
+        this->file.setFileName(this->copy.fileName());
+        if (QFileInfo::exists(this->spellingFile)) {
+            try {
+                copyToTemporary(this->spellingFile, copyDir, this->spellingCopy);
+                this->spellingFile = this->spellingCopy.fileName();
+            } catch (std::exception &e) {
+                qDebug() << "spelling suggestions disabled for" << filename << ":" << e.what();
+                this->spellingAttempted = true;
+            }
+        }
+    }
+    if (!this->file.open(QFile::ReadOnly)) {
+        throw std::runtime_error("failed to open dictionary file " + filename.toStdString());
+    }
+    this->size = this->file.size();
+    this->data = this->file.map(0, this->size);
+    if (this->data == nullptr) {
+        throw std::runtime_error("failed to map dictionary file " + filename.toStdString());
+    }
+
+    DictReader reader{this->data, this->size};
+    reader.readIntoDictionary(this);
+
+    this->bloom.reset(this->entries.size(), BLOOM_BITS_PER_KEY);
+    quint32 numPhrases = 0;
+    for (quint32 id = 0; id < this->entries.size(); id++) {
+        QByteArray key = this->keyBytes(id);
+        this->bloom.insert(PerfectHash::hashKey(key));
+        if (PhraseFilter::isPhrase(key)) {
+            numPhrases++;
+        }
+    }
+
+    this->phrases.reset(numPhrases);
+    for (quint32 id = 0; id < this->entries.size(); id++) {
+        QByteArray key = this->keyBytes(id);
+        if (PhraseFilter::isPhrase(key)) {
+            this->phrases.insert(QString::fromUtf8(key));
+        }
+    }
+}
+
+const QString &DictionaryLayer::fileName() const {
+    return this->filename;
+}
+
+DictEntry *DictionaryLayer::lookup(const QByteArray &key, const quint64 hash) {
+    if (!this->bloom.mightContain(hash)) {
+        return nullptr;
+    }
+    qint64 slot = this->hash.findHash(hash);
+    if (slot < 0 || this->keyBytes(slot) != key) {
+        return nullptr;
+    }
+    return &this->entries[slot];
+}
+
+DictEntry *DictionaryLayer::entry(const quint32 id) {
+    if (id >= this->entries.size()) {
+        throw std::runtime_error("entry " + std::to_string(id) + " does not exist");
+    }
+    return &this->entries[id];
+}
+
+bool DictionaryLayer::contains(const DictEntry *entry) const {
+    return entry >= this->entries.data() && entry < this->entries.data() + this->entries.size();
+}
+
+quint32 DictionaryLayer::entryId(const DictEntry *entry) const {
+    if (!this->contains(entry)) {
+        throw std::runtime_error("entry is not part of this dictionary");
+    }
+    return entry - this->entries.data();
+}
+
+QString DictionaryLayer::key(const DictEntry *entry) const {
+    return QString::fromUtf8(this->keyBytes(this->entryId(entry)));
+}
+
+QList<SyntaxInfo> DictionaryLayer::syntaxInfos(const DictEntry *entry) const {
+    QString word = this->key(entry);
+
+    QList<SyntaxInfo> infos;
+    for (const Inflection &inflection : entry->inflections) {
+        const QString &lemma = this->lemmas[inflection.lemma];
+        const Paradigm &paradigm = this->paradigms[inflection.paradigm];
+        for (const InflectionRule &rule : paradigm.rules) {
+            if (rule.strip > lemma.size() || lemma.left(lemma.size() - rule.strip) + rule.append != word) {
+                continue;
+            }
+            SyntaxInfo info;
+            info.partOfSpeech = paradigm.partOfSpeech;
+            // empty when the entry is its own lemma
+            info.lemma = lemma == word ? QString() : lemma;
+            info.morphosyntacticTag = rule.morphosyntacticTag;
+            infos.append(info);
+        }
+    }
+    return infos;
+}
+
+QList<DictionaryMatch> DictionaryLayer::complete(const QString &prefix, const int limit) {
+    QList<DictionaryMatch> matches;
+    for (const DawgMatch &match : this->dawg.prefixMatches(prefix.toUtf8(), limit)) {
+        matches.append(DictionaryMatch{QString::fromUtf8(match.key), this->entry(match.entryId), match.distance});
+    }
+    return matches;
+}
+
+QList<DictionaryMatch> DictionaryLayer::fuzzy(const QString &word, const int maxDistance, const int limit) {
+    QList<DictionaryMatch> matches;
+    for (const DawgMatch &match : this->dawg.fuzzyMatches(word, maxDistance, limit)) {
+        matches.append(DictionaryMatch{QString::fromUtf8(match.key), this->entry(match.entryId), match.distance});
+    }
+    return matches;
+}
+
+const Dawg &DictionaryLayer::keyIndex() const {
+    return this->dawg;
+}
+
+const PhraseFilter &DictionaryLayer::phraseFilter() const {
+    return this->phrases;
+}
+
+quint32 DictionaryLayer::numEntries() const {
+    return this->entries.size();
+}
+
+QList<DictEntry *> DictionaryLayer::lookupFolded(const QString &word) {
+    QList<DictEntry *> out;
+    QString folded = FoldIndex::fold(word);
+    // a word without accents may also be a headword as written, e.g. "a" and "à"
+    QByteArray key = folded.toUtf8();
+    DictEntry *exact = this->lookup(key, PerfectHash::hashKey(key));
+    if (exact != nullptr) {
+        out.append(exact);
+    }
+    for (quint32 id : this->foldIndex.candidates(key)) {
+        DictEntry *candidate = this->entry(id);
+        if (candidate != exact) {
+            out.append(candidate);
+        }
+    }
+    return out;
+}
+
+const FoldIndex &DictionaryLayer::foldedKeyIndex() const {
+    return this->foldIndex;
+}
+
+QList<DictionaryMatch> DictionaryLayer::suggest(const QString &word, const int maxDistance) {
+    QMutexLocker locker(&this->spellingLock);
+    if (!this->spellingAttempted) {
+        this->spellingAttempted = true;
+        try {
+            this->spelling.load(this->spellingFile);
+        } catch (std::exception &e) {
+            qDebug() << "spelling suggestions disabled for" << this->filename << ":" << e.what();
+        }
+    }
+
+    QVector<uint> target = word.toUcs4();
+    QList<DictionaryMatch> matches;
+    for (quint32 id : this->spelling.candidates(word, maxDistance)) {
+        QString key = QString::fromUtf8(this->keyBytes(id));
+        int distance = SpellingIndex::editDistance(target, key.toUcs4(), maxDistance);
+        if (distance <= maxDistance) {
+            matches.append(DictionaryMatch{key, this->entry(id), distance});
+        }
+    }
+    return matches;
+}
+
+QList<GlossMatch> DictionaryLayer::reverseSearch(const QString &query, const int limit) {
+    return this->glossIndex.search(query, limit);
+}
+
+QJsonObject DictionaryLayer::memoryUsage() const {
+    qint64 overhead = (qint64) this->entries.capacity() * sizeof(DictEntry);
+
+    qint64 inflections = 0;
+    qint64 definitionRefs = 0;
+    for (const DictEntry &entry : this->entries) {
+        qint64 inflectionsPayload = (qint64) entry.inflections.size() * sizeof(Inflection);
+        qint64 definitionsPayload = (qint64) entry.definitions.size() * sizeof(DefinitionRef);
+        inflections += inflectionsPayload;
+        definitionRefs += definitionsPayload;
+        overhead += MemoryUtils::heapSize(entry.inflections) - inflectionsPayload;
+        overhead += MemoryUtils::heapSize(entry.definitions) - definitionsPayload;
+    }
+
+    qint64 syntaxInfos = inflections + MemoryUtils::heapSize(this->lemmas) + MemoryUtils::heapSize(this->paradigms);
+    for (const QString &lemma : this->lemmas) {
+        syntaxInfos += MemoryUtils::heapSize(lemma);
+    }
+    for (const Paradigm &paradigm : this->paradigms) {
+        syntaxInfos += MemoryUtils::heapSize(paradigm.partOfSpeech) + MemoryUtils::heapSize(paradigm.rules);
+        for (const InflectionRule &rule : paradigm.rules) {
+            syntaxInfos += MemoryUtils::heapSize(rule.append) + MemoryUtils::heapSize(rule.morphosyntacticTag);
+        }
+    }
+
+    qint64 cachedBytes;
+    int cachedBlocks;
+    {
+        QMutexLocker locker(&this->blockCacheLock);
+        cachedBytes = this->blockCache.totalCost();
+        cachedBlocks = this->blockCache.size();
+    }
+    // decoded blocks are QByteArrays held by a QCache node each
+    cachedBytes += (qint64) cachedBlocks * (sizeof(QByteArray) + sizeof(QArrayData) + 4 * sizeof(void *));
+
+    qint64 spellingSize;
+    {
+        QMutexLocker locker(&this->spellingLock);
+        spellingSize = this->spelling.mappedSize();
+    }
+
+    auto section = [this](DictSectionId id) {
+        return this->sectionSizes.value(id, 0);
+    };
+    qint64 sectionsSize = 0;
+    for (qint64 length : this->sectionSizes) {
+        sectionsSize += length;
+    }
+
+    struct Category {
+        const char *name;
+        qint64 heap;
+        qint64 mapped;
+    };
+    const Category categories[] = {
+        {"keys", 0, section(DICT_SECTION_KEYS)},
+        {"definitions", definitionRefs + MemoryUtils::heapSize(this->blocks), section(DICT_SECTION_DEFINITIONS)},
+        {"definitionCache", cachedBytes, 0},
+        // decoded from the entries section when the file is loaded
+        {"syntaxInfos", syntaxInfos, section(DICT_SECTION_ENTRIES)},
+        {"hash", (qint64) (this->bloom.sizeInBits() + this->phrases.stats().bits) / 8, section(DICT_SECTION_PERFECT_HASH)},
+        {"keyIndexes", 0, section(DICT_SECTION_KEY_INDEX) + section(DICT_SECTION_FOLD_INDEX) + section(DICT_SECTION_GLOSS_INDEX) + spellingSize},
+        // the header, padding and sections this version skips
+        {"overhead", overhead, this->size - sectionsSize},
+    };
+
+    QJsonObject usage;
+    qint64 heap = 0;
+    qint64 mapped = 0;
+    for (const Category &category : categories) {
+        usage[category.name] = QJsonObject{{"heap", category.heap}, {"mapped", category.mapped}};
+        heap += category.heap;
+        mapped += category.mapped;
+    }
+    return QJsonObject{
+        {"file", this->filename},
+        {"entries", (qint64) this->entries.size()},
+        {"cachedDefinitionBlocks", cachedBlocks},
+        {"heap", heap},
+        {"mapped", mapped},
+        {"categories", usage}
+    };
+}
+
+QByteArray DictionaryLayer::keyBytes(const quint32 id) const {
+    quint32 start = qFromLittleEndian<quint32>(this->keyOffsets + id * 4);
+    quint32 end = qFromLittleEndian<quint32>(this->keyOffsets + (id + 1) * 4);
+    return QByteArray::fromRawData((const char *) this->keys + start, end - start);
+}
+
+QString DictionaryLayer::definition(const DefinitionRef &ref) {
+    QByteArray block = this->definitionBlock(ref.block);
+    if ((qint64) ref.offset + ref.length > block.size()) {
+        throw std::runtime_error("definition out of bounds of block " + std::to_string(ref.block));
+    }
+    return QString::fromUtf8(block.constData() + ref.offset, ref.length);
+}
+
+QByteArray DictionaryLayer::definitionBlock(const quint32 index) {
+    QMutexLocker locker(&this->blockCacheLock);
+    QByteArray *cached = this->blockCache.object(index);
+    if (cached != nullptr) {
+        return *cached;
+    }
+
+    if (index >= (quint32) this->blocks.size()) {
+        throw std::runtime_error("definition block " + std::to_string(index) + " does not exist");
+    }
+    const DefinitionBlock &block = this->blocks[index];
+    this->checkBlock(index);
+
+    QByteArray decoded(block.size, Qt::Uninitialized);
+    uLongf decodedLen = block.size;
+    int res = uncompress((Bytef *) decoded.data(), &decodedLen, this->data + block.offset, block.compressedSize);
+    if (res != Z_OK || decodedLen != block.size) {
+        throw std::runtime_error("failed to decompress definition block " + std::to_string(index));
+    }
+
+    this->blockCache.insert(index, new QByteArray(decoded), block.size);
+    return decoded;
+}
+
+void DictionaryLayer::checkBlock(const quint32 index) const {
+    const DefinitionBlock &block = this->blocks[index];
+    if (block.hasCrc && Crc32c::update(0, this->data + block.offset, block.compressedSize) != block.crc) {
+        throw std::runtime_error("definition block " + std::to_string(index) + " is corrupt");
+    }
+}
+
+void DictionaryLayer::verifyDefinitions() const {
+    for (int i = 0; i < this->blocks.size(); i++) {
+        this->checkBlock(i);
+    }
+}
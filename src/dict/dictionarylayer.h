@@ -0,0 +1,135 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_DICTIONARYLAYER_H
+#define MEMENTO_DICTIONARYLAYER_H
+
+#include <QString>
+#include <QList>
+#include <QStringList>
+#include <QFile>
+#include <QCache>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QTemporaryFile>
+#include <QVector>
+#include <vector>
+#include "expression.h"
+#include "perfecthash.h"
+#include "bloomfilter.h"
+#include "phrasefilter.h"
+#include "dawg.h"
+#include "foldindex.h"
+#include "spellingindex.h"
+#include "glossindex.h"
+
+/* A zlib compressed run of definitions that can be decoded on its own */
+struct DefinitionBlock {
+    qint64 offset;
+    quint32 compressedSize;
+    quint32 size;
+    /* Checked when the block is first decompressed, files without DICT_FEATURE_BLOCK_CRC were checked at load */
+    bool hasCrc;
+    quint32 crc;
+};
+
+struct DictionaryMatch {
+    QString key;
+    DictEntry *entry;
+    int distance;
+};
+
+/**
+ * One dictionary file generated by memento-dictc, e.g. the base dictionary or a user glossary.
+ * Dictionary stacks layers and merges their results.
+ */
+class DictionaryLayer {
+
+public:
+    /**
+     * Map filename, its spelling index is filename + ".spell" and is only mapped when needed.
+     * With a copyDir both files are copied there first and the copies are mapped, so the originals can be
+     * overwritten in place while this layer lives. The copies are removed with the layer.
+     */
+    explicit DictionaryLayer(const QString &filename, const QString &copyDir = QString());
+
+    const QString &fileName() const;
+    quint32 numEntries() const;
+
+    /* Entry for a key hashed with PerfectHash::hashKey, a bloom filter answers most misses without touching the file */
+    DictEntry *lookup(const QByteArray &key, quint64 hash);
+    DictEntry *entry(quint32 id);
+    bool contains(const DictEntry *entry) const;
+    QString key(const DictEntry *entry) const;
+
+    QList<SyntaxInfo> syntaxInfos(const DictEntry *entry) const;
+    QString definition(const DefinitionRef &ref);
+
+    QList<DictionaryMatch> complete(const QString &prefix, int limit);
+    QList<DictionaryMatch> fuzzy(const QString &word, int maxDistance, int limit);
+    const Dawg &keyIndex() const;
+    /* Checked before extending a walk of keyIndex by another word */
+    const PhraseFilter &phraseFilter() const;
+    QList<DictEntry *> lookupFolded(const QString &word);
+    const FoldIndex &foldedKeyIndex() const;
+    /* Unsorted spelling corrections, every match is within maxDistance */
+    QList<DictionaryMatch> suggest(const QString &word, int maxDistance);
+    QList<GlossMatch> reverseSearch(const QString &query, int limit);
+
+    /* Check every definition block against its checksum, which loading leaves until a block is first read */
+    void verifyDefinitions() const;
+
+    /**
+     * Bytes by category. Heap is allocated by this process, mapped is the part of the file a category
+     * reads, which is only resident once it is paged in. Overhead is container headers and slack
+     */
+    QJsonObject memoryUsage() const;
+
+private:
+    friend class DictReader;
+
+    quint32 entryId(const DictEntry *entry) const;
+    QByteArray keyBytes(quint32 id) const;
+    QByteArray definitionBlock(quint32 index);
+    void checkBlock(quint32 index) const;
+
+    /* The dictionary file stays mapped so definitions can be decompressed on demand */
+    QString filename;
+    /* Private copies when a copyDir is given, declared first so they are removed after being unmapped */
+    QTemporaryFile copy;
+    QTemporaryFile spellingCopy;
+    QString spellingFile;
+    QFile file;
+    const uchar *data;
+    qint64 size;
+
+    /* Entries are indexed by the slot the perfect hash gives their key */
+    std::vector<DictEntry> entries;
+    QStringList lemmas;
+    QVector<Paradigm> paradigms;
+    PerfectHash hash;
+    BloomFilter bloom;
+    PhraseFilter phrases;
+    Dawg dawg;
+    FoldIndex foldIndex;
+    GlossIndex glossIndex;
+    const uchar *keyOffsets;
+    const uchar *keys;
+    /* Length of each section of the file by DictSectionId */
+    QHash<quint32, qint64> sectionSizes;
+
+    /* Only needed once a word has no match, so it is not mapped until then */
+    SpellingIndex spelling;
+    bool spellingAttempted;
+    mutable QMutex spellingLock;
+
+    QVector<DefinitionBlock> blocks;
+    QCache<quint32, QByteArray> blockCache;
+    mutable QMutex blockCacheLock;
+
+};
+
+
+#endif //MEMENTO_DICTIONARYLAYER_H
@@ -0,0 +1,116 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "dictionarywatcher.h"
+#include "dictionary.h"
+#include "../util/directoryutils.h"
+#include "../util/globalmediator.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <memory>
+
+static const int SETTLE_MSECS = 1000;
+
+DictionaryWatcher::DictionaryWatcher(QObject *parent) : QObject(parent), reloading(false), reloadAgain(false) {
+    this->settleTimer.setSingleShot(true);
+    this->settleTimer.setInterval(SETTLE_MSECS);
+    connect(&this->settleTimer, &QTimer::timeout, this, &DictionaryWatcher::reload);
+
+    // a replaced file stops being watched, the directory catches it coming back
+    connect(&this->watcher, &QFileSystemWatcher::fileChanged, this, &DictionaryWatcher::filesChanged);
+    connect(&this->watcher, &QFileSystemWatcher::directoryChanged, this, &DictionaryWatcher::filesChanged);
+    this->watcher.addPath(QFileInfo(DirectoryUtils::getDictionaryFile()).absolutePath());
+    this->watchFiles();
+    this->states = this->fileStates();
+}
+
+QStringList DictionaryWatcher::dictionaryFiles() const {
+    QStringList files;
+    for (const QString &file : {DirectoryUtils::getDictionaryFile(), DirectoryUtils::getDictionaryCssFile()}) {
+        if (QFileInfo::exists(file)) {
+            files.append(file);
+        }
+    }
+
+    QDir layersDir(DirectoryUtils::getDictionaryLayersDir());
+    if (layersDir.exists()) {
+        for (const QString &layerFile : layersDir.entryList({"*.dict"}, QDir::Files)) {
+            files.append(layersDir.filePath(layerFile));
+        }
+    }
+    return files;
+}
+
+QMap<QString, QPair<qint64, qint64>> DictionaryWatcher::fileStates() const {
+    QMap<QString, QPair<qint64, qint64>> states;
+    for (const QString &file : this->dictionaryFiles()) {
+        QFileInfo info(file);
+        states.insert(file, {info.size(), info.lastModified().toMSecsSinceEpoch()});
+    }
+    return states;
+}
+
+void DictionaryWatcher::watchFiles() {
+    // layers are added and removed by dropping files into their directory, which may not exist yet
+    QDir layersDir(DirectoryUtils::getDictionaryLayersDir());
+    if (layersDir.exists() && !this->watcher.directories().contains(layersDir.absolutePath())) {
+        this->watcher.addPath(layersDir.absolutePath());
+    }
+
+    for (const QString &file : this->dictionaryFiles()) {
+        if (!this->watcher.files().contains(file)) {
+            this->watcher.addPath(file);
+        }
+    }
+}
+
+void DictionaryWatcher::filesChanged() {
+    this->watchFiles();
+
+    // settings saves and other files in the watched directories do not touch the dictionary
+    QMap<QString, QPair<qint64, qint64>> states = this->fileStates();
+    if (states == this->states) {
+        return;
+    }
+    this->states = states;
+    this->settleTimer.start();
+}
+
+void DictionaryWatcher::reload() {
+    if (this->reloading) {
+        // files changed again while loading, load once more when done
+        this->reloadAgain = true;
+        return;
+    }
+    this->reloading = true;
+
+    QThreadPool::globalInstance()->start(
+        [=] {
+            std::shared_ptr<Dictionary> dictionary;
+            try {
+                dictionary = std::make_shared<Dictionary>();
+            } catch (std::exception &e) {
+                qDebug() << "keeping current dictionary, reload failed:" << e.what();
+            }
+
+            QMetaObject::invokeMethod(this,
+                [=] {
+                    if (dictionary) {
+                        GlobalMediator::getGlobalMediator()->setDictionary(dictionary);
+                    }
+                    this->reloading = false;
+                    if (this->reloadAgain) {
+                        this->reloadAgain = false;
+                        this->reload();
+                    }
+                },
+                Qt::QueuedConnection
+            );
+        }
+    );
+}
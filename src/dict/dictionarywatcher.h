@@ -0,0 +1,47 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_DICTIONARYWATCHER_H
+#define MEMENTO_DICTIONARYWATCHER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QMap>
+#include <QPair>
+#include <QTimer>
+
+/**
+ * Rebuilds the dictionary in the background when its files change, then publishes it through GlobalMediator.
+ * Every snapshot maps private copies of the files, so they can be updated in place or replaced while
+ * snapshots are in use. A snapshot removes its copies once the last user releases it.
+ */
+class DictionaryWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit DictionaryWatcher(QObject *parent = nullptr);
+
+private Q_SLOTS:
+    void filesChanged();
+    void reload();
+
+private:
+    /* Dictionary files that exist now, the layers included */
+    QStringList dictionaryFiles() const;
+    /* Size and modification time of each dictionary file */
+    QMap<QString, QPair<qint64, qint64>> fileStates() const;
+    void watchFiles();
+
+    QFileSystemWatcher watcher;
+    /* The directories also hold settings and other files, their changes are told apart by these */
+    QMap<QString, QPair<qint64, qint64>> states;
+    /* Waits for writes to settle so a half written file is not loaded */
+    QTimer settleTimer;
+    bool reloading;
+    bool reloadAgain;
+
+};
+
+
+#endif //MEMENTO_DICTIONARYWATCHER_H
@@ -3,36 +3,42 @@
 //
 
 #include "dictreader.h"
+#include "dictformat.h"
+#include "crc32c.h"
 
 #include <QDebug>
+#include <QHash>
 #include <QtEndian>
+#include <cstring>
+#include <functional>
 #include <zlib.h>
-#include <cerrno>
 
 static const size_t BUF_SIZE = 131072;
 
-DictReader::DictReader(const QString filename) {
+DictReader::DictReader(const uchar *data, const qint64 size) : data(data), size(size), pos(0), stream() {
     this->buf = new uint8_t[BUF_SIZE];
-
-    std::string fileStr = filename.toStdString();
-    errno = 0;
-    this->file = gzopen(fileStr.c_str(), "rb");
-    if (this->file == Z_NULL) {
-        if (errno == 0) {
-            throw std::runtime_error("failed to open file " + fileStr);
-        } else {
-            throw std::system_error(errno, std::generic_category(), fileStr);
-        }
-    }
 }
 
 DictReader::~DictReader() {
     delete[] this->buf;
-    if (this->file != Z_NULL) {
-        if (gzclose(this->file) != Z_OK) {
-            qDebug() << "failed to close gzip file";
-        }
+}
+
+uint64_t DictReader::readRawUInt64() {
+    if (this->pos + 8 > this->size) {
+        throw std::runtime_error("dictionary file truncated at offset " + std::to_string(this->pos));
+    }
+    uint64_t value = qFromLittleEndian<quint64>(this->data + this->pos);
+    this->pos += 8;
+    return value;
+}
+
+uint32_t DictReader::readRawUInt32() {
+    if (this->pos + 4 > this->size) {
+        throw std::runtime_error("dictionary file truncated at offset " + std::to_string(this->pos));
     }
+    uint32_t value = qFromLittleEndian<quint32>(this->data + this->pos);
+    this->pos += 4;
+    return value;
 }
 
 void DictReader::readBytes(int len) {
@@ -40,17 +46,14 @@ void DictReader::readBytes(int len) {
         throw std::runtime_error("read length " + std::to_string(len) + " greater than maximum of " + std::to_string(BUF_SIZE));
     }
 
-    int readLen = 0;
-    while (readLen < len) {
-        int gzResponse = gzread(this->file, this->buf + readLen, len - readLen);
-        if (gzResponse > 0) {
-            readLen += gzResponse;
-        } else if (gzResponse == 0 && gzeof(this->file)) {
-            throw std::runtime_error("gzip eof before end of data");
-        } else {
-            int errnum;
-            const char* errStr = gzerror(this->file, &errnum);
-            throw std::runtime_error(errStr);
+    this->stream.next_out = this->buf;
+    this->stream.avail_out = len;
+    while (this->stream.avail_out > 0) {
+        int zResponse = inflate(&this->stream, Z_NO_FLUSH);
+        if (zResponse == Z_STREAM_END && this->stream.avail_out > 0) {
+            throw std::runtime_error("zlib eof before end of data");
+        } else if (zResponse != Z_OK && zResponse != Z_STREAM_END) {
+            throw std::runtime_error(this->stream.msg != nullptr ? std::string(this->stream.msg) : "zlib error " + std::to_string(zResponse));
         }
     }
 }
@@ -72,40 +75,271 @@ QString DictReader::readString() {
     return QString(bytes);
 }
 
-QList<QString> DictReader::readStrings() {
-    QList<QString> strings;
-    int numStrings = this->readUInt8();
-    for (int i = 0; i < numStrings; i++) {
-        strings.append(this->readString());
+uint16_t DictReader::readUInt16() {
+    this->readBytes(2);
+    return qFromLittleEndian(*((uint16_t*) this->buf));
+}
+
+Paradigm DictReader::readParadigm() {
+    Paradigm paradigm;
+    paradigm.partOfSpeech = this->readString();
+    int len = this->readUInt16();
+    paradigm.rules.reserve(len);
+    for (int i = 0; i < len; i++) {
+        InflectionRule rule;
+        rule.strip = this->readUInt16();
+        rule.append = this->readString();
+        rule.morphosyntacticTag = this->readString();
+        paradigm.rules.append(rule);
+    }
+    return paradigm;
+}
+
+QVector<Inflection> DictReader::readInflections() {
+    QVector<Inflection> inflections;
+    int len = this->readUInt8();
+    inflections.reserve(len);
+    for (int i = 0; i < len; i++) {
+        Inflection inflection;
+        inflection.lemma = this->readUInt32();
+        inflection.paradigm = this->readUInt32();
+        inflections.append(inflection);
     }
-    return strings;
+    return inflections;
 }
 
-SyntaxInfo DictReader::readSyntaxInfo() {
-    SyntaxInfo info;
-    info.partOfSpeech = this->readString();
-    info.lemma = this->readString();
-    info.morphosyntacticTag = this->readString();
-    return info;
+DefinitionRef DictReader::readDefinitionRef() {
+    DefinitionRef ref;
+    ref.block = this->readUInt32();
+    ref.offset = this->readUInt32();
+    ref.length = this->readUInt32();
+    return ref;
 }
 
-QList<SyntaxInfo> DictReader::readSyntaxInfos() {
-    QList<SyntaxInfo> infos;
+QList<DefinitionRef> DictReader::readDefinitionRefs() {
+    QList<DefinitionRef> refs;
     int len = this->readUInt8();
     for (int i = 0; i < len; i++) {
-        infos.append(this->readSyntaxInfo());
+        refs.append(this->readDefinitionRef());
     }
-    return infos;
+    return refs;
 }
 
-void DictReader::readIntoDictionary(Dictionary *dict) {
-    int numEntries = this->readUInt32();
-    dict->map.reserve(numEntries);
-    for (int i = 0; i < numEntries; i++) {
-        QString word = this->readString();
-        DictEntry *entry = new DictEntry;
-        entry->syntaxInfos = this->readSyntaxInfos();
-        entry->definitions = this->readStrings();
-        dict->map[word] = entry;
+void DictReader::readIntoDictionary(DictionaryLayer *dict) {
+    if (this->size >= DICT_MAGIC_SIZE && memcmp(this->data, DICT_MAGIC, DICT_MAGIC_SIZE) == 0) {
+        this->pos = DICT_MAGIC_SIZE;
+        uint32_t version = this->readRawUInt32();
+        switch (version) {
+        case DICT_VERSION:
+            this->readVersion2(dict);
+            break;
+        default:
+            throw std::runtime_error("dictionary format version " + std::to_string(version) + " is not supported, the newest supported is " + std::to_string(DICT_VERSION));
+        }
+    } else if (this->size >= 2 && this->data[0] == 0x1f && this->data[1] == 0x8b) {
+        // the whole file used to be one gzip stream
+        throw std::runtime_error("dictionary is in the old gzip format, rebuild it with memento-dictc");
+    } else {
+        throw std::runtime_error("not a dictionary file, build one with memento-dictc");
+    }
+}
+
+void DictReader::readVersion2(DictionaryLayer *dict) {
+    uint32_t features = this->readRawUInt32();
+    if (features & ~DICT_FEATURES_SUPPORTED) {
+        throw std::runtime_error("dictionary uses unsupported features " + std::to_string(features & ~DICT_FEATURES_SUPPORTED));
+    }
+    uint32_t numSections = this->readRawUInt32();
+    uint32_t headerCrc = this->readRawUInt32();
+    qint64 directorySize = (qint64) numSections * DICT_SECTION_INFO_SIZE;
+    if (this->pos + directorySize > this->size) {
+        throw std::runtime_error("dictionary section directory extends past end of file");
+    }
+    static const uchar zeroCrc[4] = {};
+    quint32 crc = Crc32c::update(0, this->data, DICT_HEADER_SIZE - 4);
+    crc = Crc32c::update(crc, zeroCrc, 4);
+    crc = Crc32c::update(crc, this->data + DICT_HEADER_SIZE, directorySize);
+    if (crc != headerCrc) {
+        throw std::runtime_error("dictionary header is corrupt");
+    }
+
+    QHash<quint32, DictSectionInfo> sections;
+    for (uint32_t i = 0; i < numSections; i++) {
+        DictSectionInfo section;
+        section.id = this->readRawUInt32();
+        section.flags = this->readRawUInt32();
+        section.codec = this->readRawUInt32();
+        section.crc = this->readRawUInt32();
+        section.offset = this->readRawUInt64();
+        section.length = this->readRawUInt64();
+        if (section.offset > (quint64) this->size || section.length > (quint64) this->size - section.offset) {
+            throw std::runtime_error("dictionary section " + std::to_string(section.id) + " extends past end of file");
+        }
+        if (section.id < DICT_SECTION_ENTRIES || section.id > DICT_SECTION_DEFINITIONS) {
+            // written by a newer memento-dictc
+            if (section.flags & DICT_SECTION_REQUIRED) {
+                throw std::runtime_error("dictionary requires unsupported section " + std::to_string(section.id));
+            }
+            qDebug() << "skipping unknown dictionary section" << section.id;
+            continue;
+        }
+        if (section.codec != (section.id == DICT_SECTION_ENTRIES ? DICT_CODEC_ZLIB : DICT_CODEC_NONE)) {
+            throw std::runtime_error("dictionary section " + std::to_string(section.id) + " has unsupported codec " + std::to_string(section.codec));
+        }
+        // with block checksums the definitions are checked block by block as they are read
+        if (section.id != DICT_SECTION_DEFINITIONS || !(features & DICT_FEATURE_BLOCK_CRC)) {
+            if (Crc32c::update(0, this->data + section.offset, section.length) != section.crc) {
+                throw std::runtime_error("dictionary section " + std::to_string(section.id) + " is corrupt");
+            }
+        }
+        sections.insert(section.id, section);
+        dict->sectionSizes[section.id] = section.length;
+    }
+
+    auto require = [&sections](DictSectionId id) -> const DictSectionInfo & {
+        auto it = sections.constFind(id);
+        if (it == sections.constEnd()) {
+            throw std::runtime_error("dictionary is missing section " + std::to_string(id));
+        }
+        return it.value();
+    };
+    // index sections are loaded in place, each must fill its section exactly
+    auto loadIndex = [this](const DictSectionInfo &section, const std::function<qint64(const uchar *, qint64)> &load) {
+        if (load(this->data + section.offset, section.length) != (qint64) section.length) {
+            throw std::runtime_error("dictionary section " + std::to_string(section.id) + " has trailing data");
+        }
+    };
+
+    const DictSectionInfo &entries = require(DICT_SECTION_ENTRIES);
+    this->pos = entries.offset;
+    this->readEntries(dict, entries.length);
+
+    const DictSectionInfo &keys = require(DICT_SECTION_KEYS);
+    this->pos = keys.offset;
+    this->readKeys(dict);
+    if (this->pos != (qint64) (keys.offset + keys.length)) {
+        throw std::runtime_error("dictionary key section has trailing data");
+    }
+
+    uint32_t numKeys = dict->entries.size();
+    loadIndex(require(DICT_SECTION_PERFECT_HASH), [&](const uchar *data, qint64 size) {
+        return dict->hash.load(data, size, numKeys);
+    });
+    loadIndex(require(DICT_SECTION_KEY_INDEX), [&](const uchar *data, qint64 size) {
+        return dict->dawg.load(data, size, numKeys);
+    });
+    // optional, lookups of unaccented words and reverse search find nothing without them
+    if (sections.contains(DICT_SECTION_FOLD_INDEX)) {
+        loadIndex(sections[DICT_SECTION_FOLD_INDEX], [&](const uchar *data, qint64 size) {
+            return dict->foldIndex.load(data, size);
+        });
+    }
+    if (sections.contains(DICT_SECTION_GLOSS_INDEX)) {
+        loadIndex(sections[DICT_SECTION_GLOSS_INDEX], [&](const uchar *data, qint64 size) {
+            return dict->glossIndex.load(data, size, numKeys);
+        });
+    }
+
+    const DictSectionInfo &definitions = require(DICT_SECTION_DEFINITIONS);
+    this->pos = definitions.offset;
+    this->readDefinitionBlocks(dict, definitions.offset + definitions.length, features & DICT_FEATURE_BLOCK_CRC);
+    // the block table in front of the blocks is all the section checksum covers
+    qint64 blockTableSize = 4 + (qint64) dict->blocks.size() * 12;
+    if ((features & DICT_FEATURE_BLOCK_CRC) &&
+        Crc32c::update(0, this->data + definitions.offset, blockTableSize) != definitions.crc) {
+        throw std::runtime_error("dictionary section " + std::to_string(definitions.id) + " is corrupt");
+    }
+}
+
+void DictReader::readEntries(DictionaryLayer *dict, const qint64 entriesSize) {
+    // paradigms and entries are a single zlib stream that is decoded eagerly
+    if (this->pos + entriesSize > this->size) {
+        throw std::runtime_error("dictionary entries extend past end of file");
+    }
+
+    this->stream = z_stream();
+    this->stream.next_in = (Bytef *) this->data + this->pos;
+    this->stream.avail_in = entriesSize;
+    if (inflateInit(&this->stream) != Z_OK) {
+        throw std::runtime_error("failed to initialize zlib");
+    }
+
+    try {
+        this->readParadigms(dict);
+        int numEntries = this->readUInt32();
+        dict->entries.resize(numEntries);
+        for (DictEntry &entry : dict->entries) {
+            entry.inflections = this->readInflections();
+            for (const Inflection &inflection : entry.inflections) {
+                if (inflection.lemma >= (quint32) dict->lemmas.size() || inflection.paradigm >= (quint32) dict->paradigms.size()) {
+                    throw std::runtime_error("inflection refers to a lemma or paradigm that does not exist");
+                }
+            }
+            entry.definitions = this->readDefinitionRefs();
+        }
+    } catch (...) {
+        inflateEnd(&this->stream);
+        throw;
+    }
+    inflateEnd(&this->stream);
+
+    this->pos += entriesSize;
+}
+
+void DictReader::readParadigms(DictionaryLayer *dict) {
+    int numLemmas = this->readUInt32();
+    dict->lemmas.reserve(numLemmas);
+    for (int i = 0; i < numLemmas; i++) {
+        dict->lemmas.append(this->readString());
+    }
+
+    int numParadigms = this->readUInt32();
+    dict->paradigms.reserve(numParadigms);
+    for (int i = 0; i < numParadigms; i++) {
+        dict->paradigms.append(this->readParadigm());
+    }
+}
+
+void DictReader::readKeys(DictionaryLayer *dict) {
+    // keys, like the indexes over them, are used straight from the mapped file
+    uint32_t numKeys = this->readRawUInt32();
+    if (numKeys != dict->entries.size()) {
+        throw std::runtime_error("dictionary has " + std::to_string(numKeys) + " keys but " + std::to_string(dict->entries.size()) + " entries");
+    }
+
+    qint64 offsetsSize = ((qint64) numKeys + 1) * 4;
+    if (this->pos + offsetsSize > this->size) {
+        throw std::runtime_error("dictionary key offsets extend past end of file");
+    }
+    dict->keyOffsets = this->data + this->pos;
+    this->pos += offsetsSize;
+
+    uint32_t keysSize = qFromLittleEndian<quint32>(dict->keyOffsets + numKeys * 4);
+    if (this->pos + keysSize > this->size) {
+        throw std::runtime_error("dictionary keys extend past end of file");
+    }
+    dict->keys = this->data + this->pos;
+    this->pos += keysSize;
+}
+
+void DictReader::readDefinitionBlocks(DictionaryLayer *dict, const qint64 end, const bool blockCrcs) {
+    // definitions stay compressed in the mapped file, only the block table is read
+    uint32_t numBlocks = this->readRawUInt32();
+    dict->blocks.reserve(numBlocks);
+    for (uint32_t i = 0; i < numBlocks; i++) {
+        DefinitionBlock block;
+        block.compressedSize = this->readRawUInt32();
+        block.size = this->readRawUInt32();
+        block.hasCrc = blockCrcs;
+        block.crc = blockCrcs ? this->readRawUInt32() : 0;
+        dict->blocks.append(block);
+    }
+
+    for (DefinitionBlock &block : dict->blocks) {
+        block.offset = this->pos;
+        this->pos += block.compressedSize;
+    }
+    if (this->pos > end) {
+        throw std::runtime_error("definition blocks extend past end of section");
     }
 }
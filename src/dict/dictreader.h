@@ -5,28 +5,43 @@
 #ifndef MEMENTO_DICTREADER_H
 #define MEMENTO_DICTREADER_H
 
-#include <QApplication>
+#include <QtGlobal>
 #include <zlib.h>
 #include "expression.h"
-#include "dictionary.h"
+#include "dictionarylayer.h"
 
 class DictReader {
 
 public:
-    DictReader(QString filename);
+    DictReader(const uchar *data, qint64 size);
     ~DictReader();
-    void readIntoDictionary(Dictionary *dict);
+    void readIntoDictionary(DictionaryLayer *dict);
 
 private:
     void readBytes(int len);
     uint32_t readUInt32();
     uint8_t readUInt8();
     QString readString();
-    QList<QString> readStrings();
-    SyntaxInfo readSyntaxInfo();
-    QList<SyntaxInfo> readSyntaxInfos();
-
-    gzFile file;
+    uint16_t readUInt16();
+    Paradigm readParadigm();
+    QVector<Inflection> readInflections();
+    DefinitionRef readDefinitionRef();
+    QList<DefinitionRef> readDefinitionRefs();
+
+    uint32_t readRawUInt32();
+    uint64_t readRawUInt64();
+    /* Sections are found through the directory, checked against their checksums and unknown optional ones skipped */
+    void readVersion2(DictionaryLayer *dict);
+    void readEntries(DictionaryLayer *dict, qint64 entriesSize);
+    void readParadigms(DictionaryLayer *dict);
+    void readKeys(DictionaryLayer *dict);
+    void readDefinitionBlocks(DictionaryLayer *dict, qint64 end, bool blockCrcs);
+
+    const uchar *data;
+    qint64 size;
+    qint64 pos;
+
+    z_stream stream;
     uint8_t *buf;
 
 };
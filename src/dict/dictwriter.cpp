@@ -0,0 +1,253 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "dictwriter.h"
+#include "crc32c.h"
+
+#include <QSaveFile>
+#include <QtEndian>
+#include <stdexcept>
+
+/* Definitions are compressed in blocks of about this many bytes so that one can be decoded on its own */
+static const int DEFINITION_BLOCK_SIZE = 32 * 1024;
+/* Entry records are deflated once this many bytes are buffered */
+static const int ENTRIES_BUFFER_SIZE = 1024 * 1024;
+
+DictWriter::DictWriter() : stream(), numEntries(0), entriesAdded(0) {
+    if (deflateInit(&this->stream, Z_BEST_COMPRESSION) != Z_OK) {
+        throw std::runtime_error("failed to initialize zlib");
+    }
+    if (!this->spool.open()) {
+        throw std::runtime_error("failed to create temporary file for definitions");
+    }
+}
+
+DictWriter::~DictWriter() {
+    deflateEnd(&this->stream);
+}
+
+void DictWriter::appendUInt8(QByteArray &out, const quint8 value) {
+    out.append((char) value);
+}
+
+void DictWriter::appendUInt16(QByteArray &out, const quint16 value) {
+    uchar buf[2];
+    qToLittleEndian(value, buf);
+    out.append((const char *) buf, 2);
+}
+
+void DictWriter::appendUInt32(QByteArray &out, const quint32 value) {
+    uchar buf[4];
+    qToLittleEndian(value, buf);
+    out.append((const char *) buf, 4);
+}
+
+void DictWriter::appendUInt64(QByteArray &out, const quint64 value) {
+    uchar buf[8];
+    qToLittleEndian(value, buf);
+    out.append((const char *) buf, 8);
+}
+
+void DictWriter::appendString(QByteArray &out, const QString &value) {
+    QByteArray bytes = value.toUtf8();
+    appendUInt32(out, bytes.size());
+    out.append(bytes);
+}
+
+DefinitionRef DictWriter::addDefinition(const QByteArray &definition) {
+    DefinitionRef ref;
+    ref.block = this->blocks.size();
+    ref.offset = this->currentBlock.size();
+    ref.length = definition.size();
+    this->currentBlock.append(definition);
+    if (this->currentBlock.size() >= DEFINITION_BLOCK_SIZE) {
+        this->flushBlock();
+    }
+    return ref;
+}
+
+void DictWriter::flushBlock() {
+    if (this->currentBlock.isEmpty()) {
+        return;
+    }
+    uLongf compressedLen = compressBound(this->currentBlock.size());
+    QByteArray compressed(compressedLen, Qt::Uninitialized);
+    int res = compress2((Bytef *) compressed.data(), &compressedLen, (const Bytef *) this->currentBlock.constData(),
+                        this->currentBlock.size(), Z_BEST_COMPRESSION);
+    if (res != Z_OK) {
+        throw std::runtime_error("failed to compress definition block " + std::to_string(this->blocks.size()));
+    }
+    if (this->spool.write(compressed.constData(), compressedLen) != (qint64) compressedLen) {
+        throw std::runtime_error("failed to write definition block to temporary file");
+    }
+    this->blocks.append(Block{(quint32) compressedLen, (quint32) this->currentBlock.size(),
+                              Crc32c::update(0, (const uchar *) compressed.constData(), compressedLen)});
+    this->currentBlock.clear();
+}
+
+void DictWriter::deflateEntries(const QByteArray &bytes, const int flush) {
+    this->stream.next_in = (Bytef *) bytes.constData();
+    this->stream.avail_in = bytes.size();
+    uchar buf[65536];
+    int res;
+    do {
+        this->stream.next_out = buf;
+        this->stream.avail_out = sizeof(buf);
+        res = deflate(&this->stream, flush);
+        if (res == Z_STREAM_ERROR) {
+            throw std::runtime_error("failed to compress entries");
+        }
+        this->entriesCompressed.append((const char *) buf, sizeof(buf) - this->stream.avail_out);
+    } while (this->stream.avail_out == 0 || (flush == Z_FINISH && res != Z_STREAM_END));
+}
+
+void DictWriter::beginEntries(const QStringList &lemmas, const QVector<Paradigm> &paradigms, const quint32 numEntries) {
+    // same layout as DictReader::readParadigms
+    appendUInt32(this->entriesBuffer, lemmas.size());
+    for (const QString &lemma : lemmas) {
+        appendString(this->entriesBuffer, lemma);
+    }
+    appendUInt32(this->entriesBuffer, paradigms.size());
+    for (const Paradigm &paradigm : paradigms) {
+        appendString(this->entriesBuffer, paradigm.partOfSpeech);
+        appendUInt16(this->entriesBuffer, paradigm.rules.size());
+        for (const InflectionRule &rule : paradigm.rules) {
+            appendUInt16(this->entriesBuffer, rule.strip);
+            appendString(this->entriesBuffer, rule.append);
+            appendString(this->entriesBuffer, rule.morphosyntacticTag);
+        }
+    }
+    appendUInt32(this->entriesBuffer, numEntries);
+    this->numEntries = numEntries;
+}
+
+void DictWriter::addEntry(const QVector<Inflection> &inflections, const QList<DefinitionRef> &definitions) {
+    if (this->entriesAdded >= this->numEntries) {
+        throw std::runtime_error("more entries added than were announced");
+    }
+    if (inflections.size() > 255 || definitions.size() > 255) {
+        throw std::runtime_error("entry has more than 255 inflections or definitions");
+    }
+    // same layout as DictReader::readInflections and readDefinitionRefs
+    appendUInt8(this->entriesBuffer, inflections.size());
+    for (const Inflection &inflection : inflections) {
+        appendUInt32(this->entriesBuffer, inflection.lemma);
+        appendUInt32(this->entriesBuffer, inflection.paradigm);
+    }
+    appendUInt8(this->entriesBuffer, definitions.size());
+    for (const DefinitionRef &ref : definitions) {
+        appendUInt32(this->entriesBuffer, ref.block);
+        appendUInt32(this->entriesBuffer, ref.offset);
+        appendUInt32(this->entriesBuffer, ref.length);
+    }
+    this->entriesAdded++;
+    if (this->entriesBuffer.size() >= ENTRIES_BUFFER_SIZE) {
+        this->deflateEntries(this->entriesBuffer, Z_NO_FLUSH);
+        this->entriesBuffer.clear();
+    }
+}
+
+void DictWriter::beginSection(QSaveFile &file, const DictSectionId id, const DictCodec codec) {
+    static const char padding[DICT_SECTION_ALIGNMENT] = {};
+    qint64 misalignment = file.pos() % DICT_SECTION_ALIGNMENT;
+    if (misalignment != 0) {
+        file.write(padding, DICT_SECTION_ALIGNMENT - misalignment);
+    }
+    // Memento works without the accent folded and gloss indexes, so older versions may skip them
+    bool optional = id == DICT_SECTION_FOLD_INDEX || id == DICT_SECTION_GLOSS_INDEX;
+    this->sections.append(DictSectionInfo{(quint32) id, optional ? 0u : DICT_SECTION_REQUIRED, (quint32) codec, 0, (quint64) file.pos(), 0});
+}
+
+void DictWriter::writeSection(QSaveFile &file, const QByteArray &bytes, const bool checksummed) {
+    if (file.write(bytes) != bytes.size()) {
+        throw std::runtime_error("failed to write dictionary section: " + file.errorString().toStdString());
+    }
+    DictSectionInfo &section = this->sections.last();
+    if (checksummed) {
+        section.crc = Crc32c::update(section.crc, bytes);
+    }
+    section.length += bytes.size();
+}
+
+QByteArray DictWriter::header() const {
+    QByteArray header(DICT_MAGIC, DICT_MAGIC_SIZE);
+    appendUInt32(header, DICT_VERSION);
+    appendUInt32(header, DICT_FEATURE_PARADIGMS | DICT_FEATURE_BLOCK_CRC);
+    appendUInt32(header, this->sections.size());
+    appendUInt32(header, 0);
+    for (const DictSectionInfo &section : this->sections) {
+        appendUInt32(header, section.id);
+        appendUInt32(header, section.flags);
+        appendUInt32(header, section.codec);
+        appendUInt32(header, section.crc);
+        appendUInt64(header, section.offset);
+        appendUInt64(header, section.length);
+    }
+    // checksum over the header and directory with the checksum itself zeroed
+    qToLittleEndian<quint32>(Crc32c::update(0, header), header.data() + DICT_HEADER_SIZE - 4);
+    return header;
+}
+
+void DictWriter::write(const QString &filename, const QVector<QByteArray> &keys, const QVector<QPair<DictSectionId, QByteArray>> &indexes) {
+    if (keys.size() != (int) this->entriesAdded || this->entriesAdded != this->numEntries) {
+        throw std::runtime_error("dictionary has " + std::to_string(keys.size()) + " keys but " + std::to_string(this->entriesAdded) + " entries");
+    }
+    this->deflateEntries(this->entriesBuffer, Z_FINISH);
+    this->entriesBuffer.clear();
+    this->flushBlock();
+
+    // a running Memento may still have the old file mapped, it is only replaced once this one is complete
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        throw std::runtime_error("failed to open " + filename.toStdString() + " for writing");
+    }
+
+    // offsets and checksums are only known once every section is written, the header is filled in last
+    this->sections.clear();
+    int numSections = 3 + indexes.size();
+    file.write(QByteArray(DICT_HEADER_SIZE + numSections * DICT_SECTION_INFO_SIZE, '\0'));
+
+    this->beginSection(file, DICT_SECTION_ENTRIES, DICT_CODEC_ZLIB);
+    this->writeSection(file, this->entriesCompressed);
+
+    this->beginSection(file, DICT_SECTION_KEYS, DICT_CODEC_NONE);
+    QByteArray keySection;
+    appendUInt32(keySection, keys.size());
+    quint32 offset = 0;
+    appendUInt32(keySection, offset);
+    for (const QByteArray &key : keys) {
+        offset += key.size();
+        appendUInt32(keySection, offset);
+    }
+    for (const QByteArray &key : keys) {
+        keySection.append(key);
+    }
+    this->writeSection(file, keySection);
+
+    for (const QPair<DictSectionId, QByteArray> &index : indexes) {
+        this->beginSection(file, index.first, DICT_CODEC_NONE);
+        this->writeSection(file, index.second);
+    }
+
+    // the blocks are compressed one by one, the section as a whole is not
+    this->beginSection(file, DICT_SECTION_DEFINITIONS, DICT_CODEC_NONE);
+    QByteArray blockTable;
+    appendUInt32(blockTable, this->blocks.size());
+    for (const Block &block : this->blocks) {
+        appendUInt32(blockTable, block.compressedSize);
+        appendUInt32(blockTable, block.size);
+        appendUInt32(blockTable, block.crc);
+    }
+    this->writeSection(file, blockTable);
+    this->spool.seek(0);
+    while (!this->spool.atEnd()) {
+        this->writeSection(file, this->spool.read(1024 * 1024), false);
+    }
+
+    file.seek(0);
+    file.write(this->header());
+    if (!file.commit()) {
+        throw std::runtime_error("failed to write " + filename.toStdString());
+    }
+}
@@ -0,0 +1,82 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_DICTWRITER_H
+#define MEMENTO_DICTWRITER_H
+
+#include <QByteArray>
+#include <QPair>
+#include <QSaveFile>
+#include <QStringList>
+#include <QString>
+#include <QTemporaryFile>
+#include <QVector>
+#include <zlib.h>
+#include "expression.h"
+#include "dictformat.h"
+
+/**
+ * Writes the dictionary file format that DictReader reads (see dictformat.h), used by memento-dictc.
+ * Definitions are packed into compressed blocks as they arrive and spooled to a temporary file,
+ * entries are deflated as they are added, so neither is ever held in memory uncompressed.
+ */
+class DictWriter {
+
+public:
+    DictWriter();
+    ~DictWriter();
+
+    /* Add a definition to the current block, definitions can be added in any order */
+    DefinitionRef addDefinition(const QByteArray &definition);
+
+    /* Paradigm tables and the number of entries that will be added, must come before any entry */
+    void beginEntries(const QStringList &lemmas, const QVector<Paradigm> &paradigms, quint32 numEntries);
+    /* Entries in the order of their key's slot in the perfect hash */
+    void addEntry(const QVector<Inflection> &inflections, const QList<DefinitionRef> &definitions);
+
+    /**
+     * Write the file, replacing filename only once it is complete
+     * @param keys utf8 headwords in slot order
+     * @param indexes section id and contents of the perfect hash, key automaton, accent folded and gloss indexes
+     */
+    void write(const QString &filename, const QVector<QByteArray> &keys, const QVector<QPair<DictSectionId, QByteArray>> &indexes);
+
+    static void appendUInt8(QByteArray &out, quint8 value);
+    static void appendUInt16(QByteArray &out, quint16 value);
+    static void appendUInt32(QByteArray &out, quint32 value);
+    static void appendUInt64(QByteArray &out, quint64 value);
+    /* u32 length then utf8, as read by DictReader::readString */
+    static void appendString(QByteArray &out, const QString &value);
+
+private:
+    void beginSection(QSaveFile &file, DictSectionId id, DictCodec codec);
+    /* Append to the section begun last, updating its length and, unless the bytes carry their own, its checksum */
+    void writeSection(QSaveFile &file, const QByteArray &bytes, bool checksummed = true);
+    /* Header and section directory, once every section is written */
+    QByteArray header() const;
+
+    void deflateEntries(const QByteArray &bytes, int flush);
+    void flushBlock();
+
+    z_stream stream;
+    QByteArray entriesCompressed;
+    quint32 numEntries;
+    quint32 entriesAdded;
+    QByteArray entriesBuffer;
+
+    struct Block {
+        quint32 compressedSize;
+        quint32 size;
+        quint32 crc;
+    };
+    QTemporaryFile spool;
+    QVector<Block> blocks;
+    QByteArray currentBlock;
+
+    QVector<DictSectionInfo> sections;
+
+};
+
+
+#endif //MEMENTO_DICTWRITER_H
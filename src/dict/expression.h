@@ -24,6 +24,10 @@
 #include <QString>
 #include <QColor>
 #include <QList>
+#include <QVector>
+#include <memory>
+
+class Dictionary;
 
 struct SyntaxInfo {
     QString partOfSpeech;
@@ -31,9 +35,35 @@ struct SyntaxInfo {
     QString morphosyntacticTag;
 };
 
+/* Location of a definition inside one of the compressed definition blocks */
+struct DefinitionRef {
+    quint32 block;
+    quint32 offset;
+    quint32 length;
+};
+
+/* Turns a lemma into one of its forms: drop strip characters from the end, then add append */
+struct InflectionRule {
+    quint16 strip;
+    QString append;
+    QString morphosyntacticTag;
+};
+
+/* Suffix rules shared by every lemma that inflects the same way */
+struct Paradigm {
+    QString partOfSpeech;
+    QVector<InflectionRule> rules;
+};
+
+/* The entry is a form of a lemma, its syntax infos are the paradigm rules that produce it */
+struct Inflection {
+    quint32 lemma;
+    quint32 paradigm;
+};
+
 struct DictEntry {
-    QList<SyntaxInfo> syntaxInfos;
-    QList<QString> definitions;
+    QVector<Inflection> inflections;
+    QList<DefinitionRef> definitions;
 };
 
 struct SubtitleCharColors {
@@ -41,10 +71,23 @@ struct SubtitleCharColors {
     QColor bgColor;
 };
 
+/**
+ * An entry together with the dictionary snapshot it belongs to.
+ * The snapshot stays alive while any handle to it exists, even after the dictionary is reloaded.
+ */
+struct DictEntryHandle {
+    std::shared_ptr<Dictionary> dictionary;
+    DictEntry *entry;
+
+    DictEntry *operator->() const { return entry; }
+    bool operator==(std::nullptr_t) const { return entry == nullptr; }
+    bool operator!=(std::nullptr_t) const { return entry != nullptr; }
+};
+
 struct SubtitlePhrase {
     int start;
     int stop;
-    DictEntry *dictEntry;
+    DictEntryHandle dictEntry;
 };
 
 struct SubtitleExtract {
@@ -0,0 +1,123 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "foldindex.h"
+#include "dictwriter.h"
+
+#include <QtEndian>
+#include <stdexcept>
+
+FoldIndex::FoldIndex() : numKeys(0), keyOffsets(nullptr), keys(nullptr), candidateOffsets(nullptr), entryIds(nullptr) {}
+
+qint64 FoldIndex::load(const uchar *data, const qint64 size) {
+    qint64 pos = 0;
+    auto require = [&](qint64 len) {
+        if (pos + len > size) {
+            throw std::runtime_error("accent folded index extends past end of file");
+        }
+    };
+
+    require(4);
+    this->numKeys = qFromLittleEndian<quint32>(data);
+    pos += 4;
+
+    qint64 offsetsSize = ((qint64) this->numKeys + 1) * 4;
+    require(offsetsSize);
+    this->keyOffsets = data + pos;
+    pos += offsetsSize;
+
+    quint32 keysSize = qFromLittleEndian<quint32>(this->keyOffsets + this->numKeys * 4);
+    require(keysSize);
+    this->keys = data + pos;
+    pos += keysSize;
+
+    require(offsetsSize);
+    this->candidateOffsets = data + pos;
+    pos += offsetsSize;
+
+    qint64 entryIdsSize = (qint64) qFromLittleEndian<quint32>(this->candidateOffsets + this->numKeys * 4) * 4;
+    require(entryIdsSize);
+    this->entryIds = data + pos;
+    pos += entryIdsSize;
+
+    return pos;
+}
+
+QByteArray FoldIndex::build(const QVector<QPair<QByteArray, QVector<quint32>>> &folded) {
+    QByteArray out;
+    DictWriter::appendUInt32(out, folded.size());
+    quint32 offset = 0;
+    DictWriter::appendUInt32(out, offset);
+    for (const auto &pair : folded) {
+        offset += pair.first.size();
+        DictWriter::appendUInt32(out, offset);
+    }
+    for (const auto &pair : folded) {
+        out.append(pair.first);
+    }
+    offset = 0;
+    DictWriter::appendUInt32(out, offset);
+    for (const auto &pair : folded) {
+        offset += pair.second.size();
+        DictWriter::appendUInt32(out, offset);
+    }
+    for (const auto &pair : folded) {
+        for (quint32 entryId : pair.second) {
+            DictWriter::appendUInt32(out, entryId);
+        }
+    }
+    return out;
+}
+
+QByteArray FoldIndex::key(const quint32 index) const {
+    quint32 start = qFromLittleEndian<quint32>(this->keyOffsets + index * 4);
+    quint32 end = qFromLittleEndian<quint32>(this->keyOffsets + (index + 1) * 4);
+    return QByteArray::fromRawData((const char *) this->keys + start, end - start);
+}
+
+quint32 FoldIndex::lowerBound(const QByteArray &key) const {
+    // keys are sorted by their utf8 bytes
+    quint32 low = 0;
+    quint32 high = this->numKeys;
+    while (low < high) {
+        quint32 mid = low + (high - low) / 2;
+        if (this->key(mid) < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+bool FoldIndex::hasPrefix(const QByteArray &prefix) const {
+    quint32 index = this->lowerBound(prefix);
+    return index < this->numKeys && this->key(index).startsWith(prefix);
+}
+
+QVector<quint32> FoldIndex::candidates(const QByteArray &folded) const {
+    QVector<quint32> out;
+    quint32 index = this->lowerBound(folded);
+    if (index < this->numKeys && this->key(index) == folded) {
+        quint32 start = qFromLittleEndian<quint32>(this->candidateOffsets + index * 4);
+        quint32 end = qFromLittleEndian<quint32>(this->candidateOffsets + (index + 1) * 4);
+        for (quint32 i = start; i < end; i++) {
+            out.append(qFromLittleEndian<quint32>(this->entryIds + i * 4));
+        }
+    }
+    return out;
+}
+
+QString FoldIndex::fold(const QString &word) {
+    QString split = word.normalized(QString::NormalizationForm_D);
+    QString out;
+    out.reserve(split.size());
+    for (QChar c : split) {
+        // combining diacritical marks
+        if (c.unicode() < 0x300 || c.unicode() > 0x36f) {
+            out += c;
+        }
+    }
+    return out;
+}
@@ -0,0 +1,56 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_FOLDINDEX_H
+#define MEMENTO_FOLDINDEX_H
+
+#include <QByteArray>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+/**
+ * Headwords with their accents removed, mapped to the entries they could stand for.
+ * Generated by memento-dictc as a sorted table in the mapped dictionary file.
+ * Only consulted when a word is not a headword as written.
+ */
+class FoldIndex {
+
+public:
+    FoldIndex();
+
+    /**
+     * Point the index at its section of the mapped dictionary file
+     * @return number of bytes the section takes up
+     */
+    qint64 load(const uchar *data, qint64 size);
+
+    /**
+     * Build the section that load reads, used by memento-dictc
+     * @param folded folded keys in byte order, each with its entry ids best guess first
+     */
+    static QByteArray build(const QVector<QPair<QByteArray, QVector<quint32>>> &folded);
+
+    /* @return true if any folded headword starts with prefix */
+    bool hasPrefix(const QByteArray &prefix) const;
+    /* Entry ids of the headwords that fold to folded, best guess first */
+    QVector<quint32> candidates(const QByteArray &folded) const;
+
+    /* Lowercase without accents, the key of the index */
+    static QString fold(const QString &word);
+
+private:
+    QByteArray key(quint32 index) const;
+    quint32 lowerBound(const QByteArray &key) const;
+
+    quint32 numKeys;
+    const uchar *keyOffsets;
+    const uchar *keys;
+    const uchar *candidateOffsets;
+    const uchar *entryIds;
+
+};
+
+
+#endif //MEMENTO_FOLDINDEX_H
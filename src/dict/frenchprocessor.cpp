@@ -43,49 +43,128 @@ SubtitleInfo FrenchProcessor::processSubtitle(QString rawText) {
 
     SubtitleInfo out;
 
+    // every phrase refers to the same snapshot, even if the dictionary is reloaded meanwhile
+    std::shared_ptr<Dictionary> dictionary = GlobalMediator::getGlobalMediator()->getDictionary();
+
+    // group hashes for the phrase filters are built from these, so no group is hashed as a whole
+    QVector<quint64> wordHashes;
+    QVector<quint64> foldedWordHashes;
+    QStringList foldedWords;
+    wordHashes.reserve(words.size());
+    for (const auto &[start, stop, word] : words) {
+        wordHashes.append(PhraseFilter::wordHash(word));
+    }
+
     for (int i = 0; i < words.size();) {
-        bool found = false;
-        for (int groupSize = std::min((int) words.size() - i, 7); groupSize >= 1; groupSize--) {
-            // try searching in the dictionary for phrases up to 7 words long
-            // longest dictionary phrase: Maison des jeunes et de la culture
-            QString group;
-            for (int wordNum = i; wordNum < i + groupSize; wordNum++) {
+        // walk each layer's key automaton one word at a time, keeping the longest group that is a headword
+        // a layer's walk stops as soon as none of its headwords start with the group
+        // longest dictionary phrase: Maison des jeunes et de la culture
+        // layers go from highest to lowest, so an equally long match in a lower layer does not replace it
+        int longestGroup = 0;
+        DictEntry *longestEntry = nullptr;
+        for (const std::unique_ptr<DictionaryLayer> &layer : dictionary->layers()) {
+            const Dawg &keyIndex = layer->keyIndex();
+            const PhraseFilter &phraseFilter = layer->phraseFilter();
+            Dawg::State state = keyIndex.root();
+            quint64 groupHash = wordHashes[i];
+            for (int wordNum = i; wordNum < words.size(); wordNum++) {
                 auto [start, stop, word] = words[wordNum];
 
+                QString group;
                 if (wordNum > i) {
                     // add space or dash between words
-                    if (rawText[start - 1] == '-') {
-                        group += '-';
-                    } else {
-                        group += ' ';
+                    QChar separator = rawText[start - 1] == '-' ? '-' : ' ';
+                    // most groups are not the start of any headword, skip those without touching the automaton
+                    groupHash = PhraseFilter::extend(groupHash, separator, wordHashes[wordNum]);
+                    if (!phraseFilter.mightContain(groupHash)) {
+                        break;
                     }
+                    group += separator;
                 }
                 group += word;
+
+                if (!keyIndex.step(state, group.toUtf8())) {
+                    if (wordNum > i) {
+                        phraseFilter.falsePositive();
+                    }
+                    break;
+                }
+                if (keyIndex.isFinal(state) && wordNum - i + 1 > longestGroup) {
+                    longestGroup = wordNum - i + 1;
+                    longestEntry = layer->entry(keyIndex.entryId(state));
+                }
             }
+        }
 
-            DictEntry *lookupResult = GlobalMediator::getGlobalMediator()->getDictionary()->map[group];
-            if (lookupResult != nullptr) {
-                SubtitlePhrase phrase{};
-                phrase.start = std::get<0>(words[i]);
-                phrase.stop = std::get<1>(words[i + groupSize - 1]);
-                phrase.dictEntry = lookupResult;
-                out.phrases.push_back(phrase);
-                found = true;
-                i += groupSize;
-                break;
+        if (longestEntry == nullptr) {
+            // subtitles with the accents dropped (ete for été), retried only after the exact walk found nothing
+            if (foldedWords.isEmpty()) {
+                for (const auto &[start, stop, word] : words) {
+                    foldedWords.append(FoldIndex::fold(word));
+                    foldedWordHashes.append(PhraseFilter::wordHash(foldedWords.last()));
+                }
+            }
+            for (const std::unique_ptr<DictionaryLayer> &layer : dictionary->layers()) {
+                const FoldIndex &foldIndex = layer->foldedKeyIndex();
+                const PhraseFilter &phraseFilter = layer->phraseFilter();
+                QString group;
+                quint64 groupHash = foldedWordHashes[i];
+                for (int wordNum = i; wordNum < words.size(); wordNum++) {
+                    int start = std::get<0>(words[wordNum]);
+                    if (wordNum > i) {
+                        QChar separator = rawText[start - 1] == '-' ? '-' : ' ';
+                        groupHash = PhraseFilter::extend(groupHash, separator, foldedWordHashes[wordNum]);
+                        if (!phraseFilter.mightContain(groupHash)) {
+                            break;
+                        }
+                        group += separator;
+                    }
+                    group += foldedWords[wordNum];
+
+                    QByteArray folded = group.toUtf8();
+                    if (!foldIndex.hasPrefix(folded)) {
+                        if (wordNum > i) {
+                            phraseFilter.falsePositive();
+                        }
+                        break;
+                    }
+                    QVector<quint32> candidates = foldIndex.candidates(folded);
+                    if (!candidates.isEmpty() && wordNum - i + 1 > longestGroup) {
+                        longestGroup = wordNum - i + 1;
+                        longestEntry = layer->entry(candidates.first());
+                    }
+                }
             }
         }
-        if (!found) {
+
+        if (longestEntry != nullptr) {
+            SubtitlePhrase phrase{};
+            phrase.start = std::get<0>(words[i]);
+            phrase.stop = std::get<1>(words[i + longestGroup - 1]);
+            phrase.dictEntry = DictEntryHandle{dictionary, longestEntry};
+            out.phrases.push_back(phrase);
+            i += longestGroup;
+        } else {
+            // still clickable, TermWidget offers spelling suggestions for words without an entry
+            SubtitlePhrase phrase{};
+            phrase.start = std::get<0>(words[i]);
+            phrase.stop = std::get<1>(words[i]);
+            phrase.dictEntry = DictEntryHandle{dictionary, nullptr};
+            out.phrases.push_back(phrase);
             i++;
         }
     }
 
+    // syntax infos are generated from paradigms, so only do it once per phrase
+    DictEntry *infosEntry = nullptr;
+    QList<SyntaxInfo> infos;
+
     for (int i = 0; i < rawText.size(); i++) {
         DictEntry *entry = nullptr;
 
         for (SubtitlePhrase &phrase : out.phrases) {
             if (i >= phrase.start && i < phrase.stop) {
-                entry = phrase.dictEntry;
+                entry = phrase.dictEntry.entry;
                 break;
             }
         }
@@ -95,13 +174,17 @@ SubtitleInfo FrenchProcessor::processSubtitle(QString rawText) {
         if (entry == nullptr) {
             colors.fgColor = Qt::white;
         } else {
-            if (entry->syntaxInfos.isEmpty()) {
+            if (entry != infosEntry) {
+                infos = dictionary->syntaxInfos(entry);
+                infosEntry = entry;
+            }
+            if (infos.isEmpty()) {
                 // example word: surendettement
                 colors.fgColor = Qt::white;
             } else {
                 bool masculine = true;
                 bool feminine = true;
-                for (SyntaxInfo &info : entry->syntaxInfos) {
+                for (SyntaxInfo &info : infos) {
                     if (!info.morphosyntacticTag.contains('f')) {
                         feminine = false;
                     }
@@ -125,8 +208,6 @@ SubtitleInfo FrenchProcessor::processSubtitle(QString rawText) {
 }
 
 QString FrenchProcessor::cleanWord(const QString word) {
-    // equivalent to python clean_word
-
     QString split = word.normalized(QString::NormalizationForm_D);
     QString lower = split.toLower().replace("œ", "oe").replace("Œ", "oe").replace("æ", "ae").replace("Æ", "ae");
     return lower.normalized(QString::NormalizationForm_C);
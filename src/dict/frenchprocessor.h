@@ -12,9 +12,8 @@ class FrenchProcessor {
 
 public:
     SubtitleInfo processSubtitle(QString rawText);
-
-private:
-    QString cleanWord(QString word);
+    /* Key form of a word, memento-dictc builds the dictionary keys with it too */
+    static QString cleanWord(QString word);
 
 };
 
@@ -0,0 +1,204 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "glossindex.h"
+#include "foldindex.h"
+#include "dictwriter.h"
+
+#include <QHash>
+#include <QSet>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+GlossIndex::GlossIndex() : numEntries(0), numTerms(0), termOffsets(nullptr), terms(nullptr), documentFrequencies(nullptr),
+                           postingOffsets(nullptr), postings(nullptr), postingsSize(0) {}
+
+qint64 GlossIndex::load(const uchar *data, const qint64 size, const quint32 numEntries) {
+    qint64 pos = 0;
+    auto require = [&](qint64 len) {
+        if (pos + len > size) {
+            throw std::runtime_error("gloss index extends past end of file");
+        }
+    };
+
+    this->numEntries = numEntries;
+    require(4);
+    this->numTerms = qFromLittleEndian<quint32>(data);
+    pos += 4;
+
+    qint64 offsetsSize = ((qint64) this->numTerms + 1) * 4;
+    require(offsetsSize);
+    this->termOffsets = data + pos;
+    pos += offsetsSize;
+
+    quint32 termsSize = qFromLittleEndian<quint32>(this->termOffsets + this->numTerms * 4);
+    require(termsSize);
+    this->terms = data + pos;
+    pos += termsSize;
+
+    require((qint64) this->numTerms * 4);
+    this->documentFrequencies = data + pos;
+    pos += (qint64) this->numTerms * 4;
+
+    require(offsetsSize);
+    this->postingOffsets = data + pos;
+    pos += offsetsSize;
+
+    this->postingsSize = qFromLittleEndian<quint32>(this->postingOffsets + this->numTerms * 4);
+    require(this->postingsSize);
+    this->postings = data + pos;
+    pos += this->postingsSize;
+
+    return pos;
+}
+
+QByteArray GlossIndex::term(const quint32 index) const {
+    quint32 start = qFromLittleEndian<quint32>(this->termOffsets + index * 4);
+    quint32 end = qFromLittleEndian<quint32>(this->termOffsets + (index + 1) * 4);
+    return QByteArray::fromRawData((const char *) this->terms + start, end - start);
+}
+
+qint64 GlossIndex::findTerm(const QByteArray &term) const {
+    quint32 low = 0;
+    quint32 high = this->numTerms;
+    while (low < high) {
+        quint32 mid = low + (high - low) / 2;
+        QByteArray midTerm = this->term(mid);
+        if (midTerm < term) {
+            low = mid + 1;
+        } else if (term < midTerm) {
+            high = mid;
+        } else {
+            return mid;
+        }
+    }
+    return -1;
+}
+
+quint32 GlossIndex::readVarint(const uchar *&pos, const uchar *end) {
+    quint32 value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos == end) {
+            throw std::runtime_error("gloss index posting is truncated");
+        }
+        uchar byte = *pos++;
+        value |= (quint32) (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    throw std::runtime_error("gloss index varint is too long");
+}
+
+void GlossIndex::appendVarint(QByteArray &out, quint32 value) {
+    while (value >= 0x80) {
+        out.append((char) (value & 0x7f | 0x80));
+        value >>= 7;
+    }
+    out.append((char) value);
+}
+
+QByteArray GlossIndex::build(const std::map<QByteArray, std::map<quint32, quint32>> &postings) {
+    // postings are sorted by entry id and stored as varint (entry id delta, weight) pairs
+    QByteArray encoded;
+    QVector<quint32> postingOffsets{0};
+    for (const auto &[term, weights] : postings) {
+        quint32 previous = 0;
+        for (const auto &[entryId, weight] : weights) {
+            appendVarint(encoded, entryId - previous);
+            appendVarint(encoded, weight);
+            previous = entryId;
+        }
+        postingOffsets.append(encoded.size());
+    }
+
+    QByteArray out;
+    DictWriter::appendUInt32(out, postings.size());
+    quint32 offset = 0;
+    DictWriter::appendUInt32(out, offset);
+    for (const auto &pair : postings) {
+        offset += pair.first.size();
+        DictWriter::appendUInt32(out, offset);
+    }
+    for (const auto &pair : postings) {
+        out.append(pair.first);
+    }
+    for (const auto &pair : postings) {
+        DictWriter::appendUInt32(out, pair.second.size());
+    }
+    for (quint32 postingOffset : postingOffsets) {
+        DictWriter::appendUInt32(out, postingOffset);
+    }
+    out.append(encoded);
+    return out;
+}
+
+QVector<GlossMatch> GlossIndex::search(const QString &query, const int limit) const {
+    QHash<quint32, double> scores;
+    QSet<QString> seen;
+    for (const QString &token : tokenize(query)) {
+        if (seen.contains(token)) {
+            continue;
+        }
+        seen.insert(token);
+
+        qint64 index = this->findTerm(token.toUtf8());
+        if (index < 0) {
+            continue;
+        }
+
+        // tf-idf, rare words count for more and repeated translations only add a little
+        quint32 documentFrequency = qFromLittleEndian<quint32>(this->documentFrequencies + index * 4);
+        double idf = std::log(1.0 + (double) this->numEntries / std::max<quint32>(documentFrequency, 1));
+
+        quint32 start = qFromLittleEndian<quint32>(this->postingOffsets + index * 4);
+        quint32 end = qFromLittleEndian<quint32>(this->postingOffsets + (index + 1) * 4);
+        if (start > end || end > this->postingsSize) {
+            throw std::runtime_error("gloss index posting out of bounds");
+        }
+        const uchar *pos = this->postings + start;
+        const uchar *postingsEnd = this->postings + end;
+        quint32 entryId = 0;
+        while (pos < postingsEnd) {
+            entryId += readVarint(pos, postingsEnd);
+            quint32 weight = readVarint(pos, postingsEnd);
+            scores[entryId] += idf * (1.0 + std::log((double) std::max<quint32>(weight, 1)));
+        }
+    }
+
+    QVector<GlossMatch> out;
+    out.reserve(scores.size());
+    for (auto it = scores.constBegin(); it != scores.constEnd(); ++it) {
+        out.append(GlossMatch{it.key(), it.value()});
+    }
+    auto byScore = [](const GlossMatch &a, const GlossMatch &b) {
+        return a.score > b.score || (a.score == b.score && a.entryId < b.entryId);
+    };
+    if (limit > 0 && out.size() > limit) {
+        std::partial_sort(out.begin(), out.begin() + limit, out.end(), byScore);
+        out.resize(limit);
+    } else {
+        std::sort(out.begin(), out.end(), byScore);
+    }
+    return out;
+}
+
+QStringList GlossIndex::tokenize(const QString &text) {
+    QStringList out;
+    QString token;
+    for (QChar c : FoldIndex::fold(text.toLower())) {
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+            token += c;
+        } else if (!token.isEmpty()) {
+            out.append(token);
+            token.clear();
+        }
+    }
+    if (!token.isEmpty()) {
+        out.append(token);
+    }
+    return out;
+}
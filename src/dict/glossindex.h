@@ -0,0 +1,66 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_GLOSSINDEX_H
+#define MEMENTO_GLOSSINDEX_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <map>
+
+struct GlossMatch {
+    quint32 entryId;
+    double score;
+};
+
+/**
+ * Inverted index from the English words in definitions to the entries they belong to.
+ * Generated by memento-dictc, postings are decoded straight from the mapped dictionary file.
+ */
+class GlossIndex {
+
+public:
+    GlossIndex();
+
+    /**
+     * Point the index at its section of the mapped dictionary file
+     * @param numEntries number of entries in the dictionary, used for ranking
+     * @return number of bytes the section takes up
+     */
+    qint64 load(const uchar *data, qint64 size, quint32 numEntries);
+
+    /**
+     * Build the section that load reads, used by memento-dictc
+     * @param postings weight of each entry for each term, terms in byte order
+     */
+    static QByteArray build(const std::map<QByteArray, std::map<quint32, quint32>> &postings);
+
+    /* Entries whose English translations best match query, highest score first */
+    QVector<GlossMatch> search(const QString &query, int limit) const;
+
+    /* Lowercase words of an English gloss or query, the terms of the index */
+    static QStringList tokenize(const QString &text);
+
+private:
+    QByteArray term(quint32 index) const;
+    /* @return index of term or -1 */
+    qint64 findTerm(const QByteArray &term) const;
+    static quint32 readVarint(const uchar *&pos, const uchar *end);
+    static void appendVarint(QByteArray &out, quint32 value);
+
+    quint32 numEntries;
+    quint32 numTerms;
+    const uchar *termOffsets;
+    const uchar *terms;
+    const uchar *documentFrequencies;
+    const uchar *postingOffsets;
+    const uchar *postings;
+    quint32 postingsSize;
+
+};
+
+
+#endif //MEMENTO_GLOSSINDEX_H
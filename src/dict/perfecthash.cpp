@@ -0,0 +1,197 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "perfecthash.h"
+#include "dictwriter.h"
+
+#include <QtEndian>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+static const quint64 FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+static const quint64 FNV_PRIME = 0x100000001b3ULL;
+static const quint64 LEVEL_SEED = 0x9e3779b97f4a7c15ULL;
+static const quint64 BITS_PER_RANK = 512;
+/* Levels in a row that place no key before giving up, only happens with duplicate keys */
+static const int MAX_STALLED_LEVELS = 8;
+
+PerfectHash::PerfectHash() : numKeys(0), bits(nullptr), ranks(nullptr), fingerprints(nullptr) {}
+
+qint64 PerfectHash::load(const uchar *data, const qint64 size, const quint32 numKeys) {
+    this->numKeys = numKeys;
+    this->levels.clear();
+
+    qint64 pos = 0;
+    auto require = [&](qint64 len) {
+        if (pos + len > size) {
+            throw std::runtime_error("perfect hash extends past end of file");
+        }
+    };
+
+    require(4);
+    quint32 numLevels = qFromLittleEndian<quint32>(data + pos);
+    pos += 4;
+
+    quint64 totalBits = 0;
+    require((qint64) numLevels * 4);
+    for (quint32 i = 0; i < numLevels; i++) {
+        Level level;
+        level.bitOffset = totalBits;
+        level.numBits = qFromLittleEndian<quint32>(data + pos);
+        pos += 4;
+        if (level.numBits == 0) {
+            throw std::runtime_error("perfect hash level " + std::to_string(i) + " is empty");
+        }
+        // levels are padded to whole 64 bit words
+        totalBits += (level.numBits + 63) / 64 * 64;
+        this->levels.append(level);
+    }
+
+    qint64 numWords = totalBits / 64;
+    require(numWords * 8);
+    this->bits = data + pos;
+    pos += numWords * 8;
+
+    qint64 numRanks = (totalBits + BITS_PER_RANK - 1) / BITS_PER_RANK;
+    require(numRanks * 4);
+    this->ranks = data + pos;
+    pos += numRanks * 4;
+
+    require(numKeys);
+    this->fingerprints = data + pos;
+    pos += numKeys;
+
+    return pos;
+}
+
+QByteArray PerfectHash::build(const QVector<quint64> &hashes, QVector<quint32> &keySlots) {
+    // each level has one bit per remaining key, keys that collide are pushed to the next level
+    QVector<quint32> levelSizes;
+    std::vector<std::pair<quint64, quint32>> placedBits; // (global bit, key index)
+    quint64 bitOffset = 0;
+    QVector<quint32> remaining(hashes.size());
+    for (int i = 0; i < remaining.size(); i++) {
+        remaining[i] = i;
+    }
+    QVector<quint64> positions;
+    QVector<quint8> counts;
+    int stalled = 0;
+    while (!remaining.isEmpty()) {
+        quint64 numBits = remaining.size();
+        quint64 seed = (levelSizes.size() + 1) * LEVEL_SEED;
+        positions.resize(remaining.size());
+        counts.fill(0, numBits);
+        for (int i = 0; i < remaining.size(); i++) {
+            positions[i] = mix(hashes[remaining[i]] + seed) % numBits;
+            // only whether a bit is hit once matters
+            counts[positions[i]] = std::min(counts[positions[i]] + 1, 2);
+        }
+
+        QVector<quint32> nextRemaining;
+        for (int i = 0; i < remaining.size(); i++) {
+            if (counts[positions[i]] == 1) {
+                placedBits.emplace_back(bitOffset + positions[i], remaining[i]);
+            } else {
+                nextRemaining.append(remaining[i]);
+            }
+        }
+
+        stalled = nextRemaining.size() == remaining.size() ? stalled + 1 : 0;
+        if (stalled > MAX_STALLED_LEVELS) {
+            throw std::runtime_error("perfect hash stuck with " + std::to_string(remaining.size()) + " keys left, duplicate keys?");
+        }
+
+        levelSizes.append(numBits);
+        bitOffset += (numBits + 63) / 64 * 64;
+        remaining = nextRemaining;
+    }
+
+    // slot of a key is the rank of its bit
+    std::sort(placedBits.begin(), placedBits.end());
+    keySlots.fill(0, hashes.size());
+    QVector<quint64> words(bitOffset / 64, 0);
+    for (quint32 slot = 0; slot < placedBits.size(); slot++) {
+        quint64 bit = placedBits[slot].first;
+        keySlots[placedBits[slot].second] = slot;
+        words[bit / 64] |= 1ULL << (bit % 64);
+    }
+
+    QByteArray out;
+    DictWriter::appendUInt32(out, levelSizes.size());
+    for (quint32 levelSize : levelSizes) {
+        DictWriter::appendUInt32(out, levelSize);
+    }
+    for (quint64 word : words) {
+        DictWriter::appendUInt64(out, word);
+    }
+    quint32 rank = 0;
+    for (int i = 0; i < words.size(); i++) {
+        if (i % (BITS_PER_RANK / 64) == 0) {
+            DictWriter::appendUInt32(out, rank);
+        }
+        rank += qPopulationCount(words[i]);
+    }
+    QByteArray fingerprints(hashes.size(), 0);
+    for (int i = 0; i < hashes.size(); i++) {
+        fingerprints[keySlots[i]] = (char) (mix(~hashes[i]) >> 56);
+    }
+    out.append(fingerprints);
+    return out;
+}
+
+qint64 PerfectHash::find(const QByteArray &key) const {
+    return this->findHash(hashKey(key));
+}
+
+qint64 PerfectHash::findHash(const quint64 hash) const {
+    for (int i = 0; i < this->levels.size(); i++) {
+        const Level &level = this->levels[i];
+        quint64 bit = level.bitOffset + mix(hash + (i + 1) * LEVEL_SEED) % level.numBits;
+        if (this->testBit(bit)) {
+            quint64 slot = this->rank(bit);
+            if (slot >= this->numKeys || this->fingerprints[slot] != (uchar) (mix(~hash) >> 56)) {
+                return -1;
+            }
+            return slot;
+        }
+    }
+    return -1;
+}
+
+bool PerfectHash::testBit(const quint64 bit) const {
+    quint64 word = qFromLittleEndian<quint64>(this->bits + bit / 64 * 8);
+    return (word >> (bit % 64)) & 1;
+}
+
+quint64 PerfectHash::rank(const quint64 bit) const {
+    quint64 block = bit / BITS_PER_RANK;
+    quint64 rank = qFromLittleEndian<quint32>(this->ranks + block * 4);
+    for (quint64 word = block * BITS_PER_RANK / 64; word < bit / 64; word++) {
+        rank += qPopulationCount(qFromLittleEndian<quint64>(this->bits + word * 8));
+    }
+    quint64 mask = (1ULL << (bit % 64)) - 1;
+    rank += qPopulationCount(qFromLittleEndian<quint64>(this->bits + bit / 64 * 8) & mask);
+    return rank;
+}
+
+quint64 PerfectHash::hashKey(const QByteArray &key) {
+    // FNV-1a
+    quint64 hash = FNV_OFFSET_BASIS;
+    for (char c : key) {
+        hash ^= (uchar) c;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+quint64 PerfectHash::mix(quint64 value) {
+    // splitmix64 finalizer
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
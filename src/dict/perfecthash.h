@@ -0,0 +1,63 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_PERFECTHASH_H
+#define MEMENTO_PERFECTHASH_H
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * Minimal perfect hash over the dictionary's headwords, generated by memento-dictc (BBHash with gamma = 1).
+ * Every key maps to a distinct slot in [0, numKeys), which is also the key's entry id.
+ * Lookups read the level bit arrays directly from the mapped dictionary file.
+ */
+class PerfectHash {
+
+public:
+    PerfectHash();
+
+    /**
+     * Point this hash at its section of the mapped dictionary file
+     * @return number of bytes the section takes up
+     */
+    qint64 load(const uchar *data, qint64 size, quint32 numKeys);
+
+    /**
+     * @return slot of the key, or -1 if the key is definitely not in the set.
+     * Keys that are not in the set can still return a slot, the caller must compare the stored key.
+     */
+    qint64 find(const QByteArray &key) const;
+    /* Same as find, for a key already hashed with hashKey */
+    qint64 findHash(quint64 hash) const;
+
+    /**
+     * Build the section that load reads, used by memento-dictc
+     * @param hashes hashKey of every key
+     * @param keySlots set to the slot of each key
+     */
+    static QByteArray build(const QVector<quint64> &hashes, QVector<quint32> &keySlots);
+
+    static quint64 hashKey(const QByteArray &key);
+    static quint64 mix(quint64 value);
+
+private:
+    struct Level {
+        quint64 bitOffset;
+        quint64 numBits;
+    };
+
+    bool testBit(quint64 bit) const;
+    quint64 rank(quint64 bit) const;
+
+    quint32 numKeys;
+    QVector<Level> levels;
+    const uchar *bits;
+    const uchar *ranks;
+    const uchar *fingerprints;
+
+};
+
+
+#endif //MEMENTO_PERFECTHASH_H
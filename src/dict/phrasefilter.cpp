@@ -0,0 +1,82 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "phrasefilter.h"
+#include "perfecthash.h"
+#include "foldindex.h"
+
+/* Each headword adds a few groups, so this stays around 1% false positives */
+static const int BITS_PER_KEY = 24;
+
+PhraseFilter::PhraseFilter() : numPhrases(0), checks(0), rejected(0), passedInError(0) {}
+
+void PhraseFilter::reset(const quint32 numKeys) {
+    this->bloom.reset(numKeys, BITS_PER_KEY);
+    this->numPhrases = 0;
+}
+
+quint64 PhraseFilter::wordHash(const QString &word) {
+    return PerfectHash::hashKey(word.toUtf8());
+}
+
+quint64 PhraseFilter::extend(const quint64 groupHash, const QChar separator, const quint64 wordHash) {
+    return PerfectHash::mix(PerfectHash::mix(groupHash ^ separator.unicode()) ^ wordHash);
+}
+
+bool PhraseFilter::isPhrase(const QByteArray &key) {
+    return key.contains(' ') || key.contains('-');
+}
+
+void PhraseFilter::insert(const QString &key) {
+    this->numPhrases++;
+    this->insertGroups(key);
+    // the accent folded walk checks the same filter
+    QString folded = FoldIndex::fold(key);
+    if (folded != key) {
+        this->insertGroups(folded);
+    }
+}
+
+void PhraseFilter::insertGroups(const QString &key) {
+    // same word boundaries as FrenchProcessor::processSubtitle, which also splits on spaces and dashes
+    quint64 groupHash = 0;
+    int wordStart = 0;
+    int numWords = 0;
+    for (int i = 0; i <= key.size(); i++) {
+        if (i < key.size() && key[i] != ' ' && key[i] != '-') {
+            continue;
+        }
+        quint64 hash = wordHash(key.mid(wordStart, i - wordStart));
+        groupHash = numWords == 0 ? hash : extend(groupHash, key[wordStart - 1], hash);
+        numWords++;
+        if (numWords > 1) {
+            this->bloom.insert(groupHash);
+        }
+        wordStart = i + 1;
+    }
+}
+
+bool PhraseFilter::mightContain(const quint64 groupHash) const {
+    this->checks++;
+    if (this->bloom.mightContain(groupHash)) {
+        return true;
+    }
+    this->rejected++;
+    return false;
+}
+
+void PhraseFilter::falsePositive() const {
+    this->passedInError++;
+}
+
+PhraseFilterStats PhraseFilter::stats() const {
+    PhraseFilterStats stats;
+    stats.phrases = this->numPhrases;
+    stats.bits = this->bloom.sizeInBits();
+    stats.estimatedFalsePositiveRate = this->bloom.estimatedFalsePositiveRate();
+    stats.checks = this->checks;
+    stats.avoidedProbes = this->rejected;
+    stats.falsePositives = this->passedInError;
+    return stats;
+}
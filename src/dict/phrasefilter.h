@@ -0,0 +1,64 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_PHRASEFILTER_H
+#define MEMENTO_PHRASEFILTER_H
+
+#include <QChar>
+#include <QString>
+#include <atomic>
+#include "bloomfilter.h"
+
+struct PhraseFilterStats {
+    quint32 phrases;
+    quint64 bits;
+    double estimatedFalsePositiveRate;
+    /* Word groups checked, and how many of them never reached the key automaton */
+    quint64 checks;
+    quint64 avoidedProbes;
+    /* Groups that passed the filter but were not the start of any headword */
+    quint64 falsePositives;
+};
+
+/**
+ * Bloom filter over the leading word groups of every multi-word headword ("pomme de", "pomme de terre").
+ * A group's hash is built up from the hashes of its words, so FrenchProcessor can drop a group
+ * before it puts the group's text together.
+ */
+class PhraseFilter {
+
+public:
+    PhraseFilter();
+
+    /* Size the filter for this many multi-word headwords, then insert each of them */
+    void reset(quint32 numKeys);
+    void insert(const QString &key);
+
+    static quint64 wordHash(const QString &word);
+    /* Hash of a group after appending a word, the first word's group hash is its word hash */
+    static quint64 extend(quint64 groupHash, QChar separator, quint64 wordHash);
+    static bool isPhrase(const QByteArray &key);
+
+    /* False when no multi-word headword starts with the group */
+    bool mightContain(quint64 groupHash) const;
+    /* The key automaton had nothing for a group that passed */
+    void falsePositive() const;
+
+    PhraseFilterStats stats() const;
+
+private:
+    void insertGroups(const QString &key);
+
+    BloomFilter bloom;
+    quint32 numPhrases;
+
+    /* Counted from whatever thread is processing subtitles */
+    mutable std::atomic<quint64> checks;
+    mutable std::atomic<quint64> rejected;
+    mutable std::atomic<quint64> passedInError;
+
+};
+
+
+#endif //MEMENTO_PHRASEFILTER_H
@@ -0,0 +1,190 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "spellingindex.h"
+#include "perfecthash.h"
+#include "dictwriter.h"
+
+#include <QtEndian>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+// header: u32 max distance, u32 prefix length, u32 number of buckets
+static const qint64 HEADER_SIZE = 12;
+/* Only the first few characters of a key get deletions, which bounds the size of the index */
+static const int BUILD_MAX_DISTANCE = 2;
+static const int BUILD_PREFIX_LENGTH = 7;
+/* Buckets are not exact, every candidate is checked against the real edit distance when queried */
+static const int PAIRS_PER_BUCKET = 8;
+
+SpellingIndex::SpellingIndex() : data(nullptr), builtDistance(0), prefixLength(0), numBuckets(0),
+                                 bucketOffsets(nullptr), entryIds(nullptr), numEntryIds(0) {}
+
+void SpellingIndex::load(const QString &filename) {
+    this->file.setFileName(filename);
+    if (!this->file.open(QFile::ReadOnly)) {
+        throw std::runtime_error("failed to open spelling index " + filename.toStdString());
+    }
+    qint64 size = this->file.size();
+    if (size < HEADER_SIZE) {
+        throw std::runtime_error("spelling index is truncated");
+    }
+    const uchar *mapped = this->file.map(0, size);
+    if (mapped == nullptr) {
+        throw std::runtime_error("failed to map spelling index " + filename.toStdString());
+    }
+
+    this->builtDistance = qFromLittleEndian<quint32>(mapped);
+    this->prefixLength = qFromLittleEndian<quint32>(mapped + 4);
+    this->numBuckets = qFromLittleEndian<quint32>(mapped + 8);
+    qint64 offsetsSize = ((qint64) this->numBuckets + 1) * 4;
+    if (this->numBuckets == 0 || HEADER_SIZE + offsetsSize > size) {
+        throw std::runtime_error("spelling index is truncated");
+    }
+    this->bucketOffsets = mapped + HEADER_SIZE;
+    this->numEntryIds = qFromLittleEndian<quint32>(this->bucketOffsets + this->numBuckets * 4);
+    if (HEADER_SIZE + offsetsSize + (qint64) this->numEntryIds * 4 > size) {
+        throw std::runtime_error("spelling index is truncated");
+    }
+    this->entryIds = this->bucketOffsets + offsetsSize;
+    this->data = mapped;
+}
+
+bool SpellingIndex::isLoaded() const {
+    return this->data != nullptr;
+}
+
+qint64 SpellingIndex::mappedSize() const {
+    return this->isLoaded() ? this->file.size() : 0;
+}
+
+int SpellingIndex::maxDistance() const {
+    return this->builtDistance;
+}
+
+QSet<QString> SpellingIndex::deletions(const QString &word, const int maxDistance) {
+    QSet<QString> out{word};
+    QSet<QString> edge{word};
+    for (int distance = 0; distance < maxDistance; distance++) {
+        QSet<QString> next;
+        for (const QString &w : edge) {
+            for (int i = 0; i < w.size(); i++) {
+                QString deletion = QString(w).remove(i, 1);
+                if (!out.contains(deletion)) {
+                    next.insert(deletion);
+                }
+            }
+        }
+        out.unite(next);
+        edge = next;
+    }
+    return out;
+}
+
+quint32 SpellingIndex::deletionHash(const QString &deletion) {
+    return PerfectHash::mix(PerfectHash::hashKey(deletion.toUtf8())) >> 32;
+}
+
+QByteArray SpellingIndex::build(const QVector<QString> &keys) {
+    // (hash of deletion << 32) | entry id
+    std::vector<quint64> pairs;
+    for (int entryId = 0; entryId < keys.size(); entryId++) {
+        if (keys[entryId].contains(' ')) {
+            continue;
+        }
+        QVector<uint> codePoints = keys[entryId].toUcs4();
+        codePoints.resize(std::min<int>(codePoints.size(), BUILD_PREFIX_LENGTH));
+        QString prefix = QString::fromUcs4(codePoints.constData(), codePoints.size());
+        for (const QString &deletion : deletions(prefix, BUILD_MAX_DISTANCE)) {
+            pairs.push_back((quint64) deletionHash(deletion) << 32 | (quint32) entryId);
+        }
+    }
+
+    quint32 numBuckets = 1;
+    while ((quint64) numBuckets * PAIRS_PER_BUCKET < pairs.size()) {
+        numBuckets *= 2;
+    }
+    for (quint64 &pair : pairs) {
+        pair = (pair >> 32) % numBuckets << 32 | (pair & 0xffffffff);
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    // an entry appears once per bucket even if several of its deletions land there
+    QVector<quint32> bucketOffsets(numBuckets + 1, 0);
+    QByteArray entryIds;
+    for (size_t i = 0; i < pairs.size(); i++) {
+        if (i > 0 && pairs[i] == pairs[i - 1]) {
+            continue;
+        }
+        bucketOffsets[(pairs[i] >> 32) + 1]++;
+        DictWriter::appendUInt32(entryIds, pairs[i] & 0xffffffff);
+    }
+    for (quint32 i = 0; i < numBuckets; i++) {
+        bucketOffsets[i + 1] += bucketOffsets[i];
+    }
+
+    QByteArray out;
+    DictWriter::appendUInt32(out, BUILD_MAX_DISTANCE);
+    DictWriter::appendUInt32(out, BUILD_PREFIX_LENGTH);
+    DictWriter::appendUInt32(out, numBuckets);
+    for (quint32 offset : bucketOffsets) {
+        DictWriter::appendUInt32(out, offset);
+    }
+    out.append(entryIds);
+    return out;
+}
+
+QSet<quint32> SpellingIndex::candidates(const QString &word, const int maxDistance) const {
+    QSet<quint32> out;
+    if (!this->isLoaded()) {
+        return out;
+    }
+
+    // the index only has deletions of each key's prefix, so the query only needs deletions of its own prefix
+    QVector<uint> codePoints = word.toUcs4();
+    codePoints.resize(std::min<int>(codePoints.size(), this->prefixLength));
+    QString prefix = QString::fromUcs4(codePoints.constData(), codePoints.size());
+
+    int distance = std::min<int>(maxDistance, this->builtDistance);
+    for (const QString &deletion : deletions(prefix, distance)) {
+        quint32 index = deletionHash(deletion) % this->numBuckets;
+        quint32 start = qFromLittleEndian<quint32>(this->bucketOffsets + index * 4);
+        quint32 end = qFromLittleEndian<quint32>(this->bucketOffsets + (index + 1) * 4);
+        if (start > end || end > this->numEntryIds) {
+            throw std::runtime_error("spelling index bucket out of bounds");
+        }
+        for (quint32 i = start; i < end; i++) {
+            out.insert(qFromLittleEndian<quint32>(this->entryIds + i * 4));
+        }
+    }
+    return out;
+}
+
+int SpellingIndex::editDistance(const QVector<uint> &a, const QVector<uint> &b, const int limit) {
+    if (std::abs(a.size() - b.size()) > limit) {
+        return limit + 1;
+    }
+
+    QVector<int> row(b.size() + 1);
+    for (int j = 0; j < row.size(); j++) {
+        row[j] = j;
+    }
+    for (int i = 1; i <= a.size(); i++) {
+        int diagonal = row[0];
+        row[0] = i;
+        int rowMin = row[0];
+        for (int j = 1; j <= b.size(); j++) {
+            int above = row[j];
+            row[j] = std::min({row[j] + 1, row[j - 1] + 1, diagonal + (a[i - 1] == b[j - 1] ? 0 : 1)});
+            diagonal = above;
+            rowMin = std::min(rowMin, row[j]);
+        }
+        if (rowMin > limit) {
+            return limit + 1;
+        }
+    }
+    return std::min(row.last(), limit + 1);
+}
@@ -0,0 +1,59 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_SPELLINGINDEX_H
+#define MEMENTO_SPELLINGINDEX_H
+
+#include <QFile>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+/**
+ * SymSpell deletion index generated by memento-dictc into its own file.
+ * Gives the entries that may be within a few edits of a word, the caller checks the real distance.
+ */
+class SpellingIndex {
+
+public:
+    SpellingIndex();
+
+    /* Map the index file, throws if it is missing or malformed */
+    void load(const QString &filename);
+    bool isLoaded() const;
+    /* Bytes of the mapped index file, 0 until it is loaded */
+    qint64 mappedSize() const;
+
+    /* Largest distance the index was built for, queries are limited to it */
+    int maxDistance() const;
+    /* Entry ids that could be within maxDistance edits of word, in no particular order */
+    QSet<quint32> candidates(const QString &word, int maxDistance) const;
+
+    /**
+     * Build the index file that load maps, used by memento-dictc
+     * @param keys headword of each entry id, keys with spaces are left out
+     */
+    static QByteArray build(const QVector<QString> &keys);
+
+    /* Levenshtein distance in code points, gives up with limit + 1 once it is exceeded */
+    static int editDistance(const QVector<uint> &a, const QVector<uint> &b, int limit);
+
+private:
+    static QSet<QString> deletions(const QString &word, int maxDistance);
+    static quint32 deletionHash(const QString &deletion);
+
+    QFile file;
+    const uchar *data;
+
+    quint32 builtDistance;
+    quint32 prefixLength;
+    quint32 numBuckets;
+    const uchar *bucketOffsets;
+    const uchar *entryIds;
+    quint32 numEntryIds;
+
+};
+
+
+#endif //MEMENTO_SPELLINGINDEX_H
@@ -0,0 +1,179 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "applebodyreader.h"
+
+#include <QFile>
+#include <QThreadPool>
+#include <QXmlStreamReader>
+#include <QtEndian>
+#include <deque>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <zlib.h>
+
+static const char *APPLE_NAMESPACE = "http://www.apple.com/DTDs/DictionaryService-1.0.rng";
+/* Offsets of the end of the chunk area and of the first chunk */
+static const qint64 LIMIT_OFFSET = 0x40;
+static const qint64 FIRST_CHUNK_OFFSET = 0x60;
+/* Each chunk starts with 8 bytes that are not part of the zlib stream */
+static const int CHUNK_HEADER_SIZE = 8;
+/* Chunks waiting to be handled, per thread of the pool */
+static const int CHUNKS_IN_FLIGHT_PER_THREAD = 2;
+
+AppleBodyReader::AppleBodyReader(const QString &filename) : filename(filename) {}
+
+void AppleBodyReader::read(const std::function<void(const AppleDefinition &)> &handler) {
+    QFile file(this->filename);
+    if (!file.open(QFile::ReadOnly)) {
+        throw std::runtime_error("failed to open apple dictionary body " + this->filename.toStdString());
+    }
+
+    auto readInt32 = [&file]() {
+        QByteArray bytes = file.read(4);
+        if (bytes.size() != 4) {
+            throw std::runtime_error("apple dictionary body is truncated");
+        }
+        return qFromLittleEndian<qint32>(bytes.constData());
+    };
+
+    file.seek(LIMIT_OFFSET);
+    qint64 limit = LIMIT_OFFSET + readInt32();
+    file.seek(FIRST_CHUNK_OFFSET);
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    size_t maxInFlight = std::max(1, pool->maxThreadCount()) * CHUNKS_IN_FLIGHT_PER_THREAD;
+    std::deque<std::future<QVector<AppleDefinition>>> pending;
+
+    auto handleOldest = [&]() {
+        for (const AppleDefinition &definition : pending.front().get()) {
+            handler(definition);
+        }
+        pending.pop_front();
+    };
+
+    try {
+        while (file.pos() < limit) {
+            qint32 size = readInt32();
+            QByteArray chunk = file.read(size);
+            if (size < CHUNK_HEADER_SIZE || chunk.size() != size) {
+                throw std::runtime_error("apple dictionary chunk at " + std::to_string(file.pos()) + " is truncated");
+            }
+
+            auto promise = std::make_shared<std::promise<QVector<AppleDefinition>>>();
+            pending.push_back(promise->get_future());
+            QByteArray compressed = chunk.mid(CHUNK_HEADER_SIZE);
+            pool->start(
+                [promise, compressed] {
+                    try {
+                        promise->set_value(parseChunk(compressed));
+                    } catch (...) {
+                        promise->set_exception(std::current_exception());
+                    }
+                }
+            );
+
+            if (pending.size() >= maxInFlight) {
+                handleOldest();
+            }
+        }
+        while (!pending.empty()) {
+            handleOldest();
+        }
+    } catch (...) {
+        // the chunks still being parsed refer to nothing on this stack, only let them finish
+        pool->waitForDone();
+        throw;
+    }
+}
+
+QByteArray AppleBodyReader::inflateChunk(const QByteArray &compressed) {
+    z_stream stream{};
+    if (inflateInit(&stream) != Z_OK) {
+        throw std::runtime_error("failed to initialize zlib");
+    }
+    stream.next_in = (Bytef *) compressed.constData();
+    stream.avail_in = compressed.size();
+
+    QByteArray out;
+    uchar buf[65536];
+    int res;
+    do {
+        stream.next_out = buf;
+        stream.avail_out = sizeof(buf);
+        res = inflate(&stream, Z_NO_FLUSH);
+        if (res != Z_OK && res != Z_STREAM_END) {
+            inflateEnd(&stream);
+            throw std::runtime_error("failed to decompress apple dictionary chunk");
+        }
+        out.append((const char *) buf, sizeof(buf) - stream.avail_out);
+    } while (res != Z_STREAM_END);
+    inflateEnd(&stream);
+    return out;
+}
+
+QVector<AppleDefinition> AppleBodyReader::parseChunk(const QByteArray &compressed) {
+    QByteArray buf = inflateChunk(compressed);
+
+    QVector<AppleDefinition> out;
+    qint64 pos = 0;
+    while (pos + 4 <= buf.size()) {
+        qint32 size = qFromLittleEndian<qint32>(buf.constData() + pos);
+        pos += 4;
+        if (size < 0 || pos + size > buf.size()) {
+            throw std::runtime_error("apple dictionary definition extends past end of chunk");
+        }
+        out.append(parseDefinition(buf.mid(pos, size)));
+        pos += size;
+    }
+    return out;
+}
+
+AppleDefinition AppleBodyReader::parseDefinition(const QByteArray &xml) {
+    AppleDefinition definition;
+    definition.language = AppleDefinition::Unknown;
+
+    QXmlStreamReader reader(xml);
+    int depth = 0;
+    // depth of the translation span being read, 0 when outside of one
+    int translationDepth = 0;
+    QString translation;
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isStartElement()) {
+            depth++;
+            QXmlStreamAttributes attributes = reader.attributes();
+            if (depth == 1) {
+                definition.id = attributes.value("id").toString();
+                definition.title = attributes.value(APPLE_NAMESPACE, "title").toString();
+            }
+            bool isTranslation = attributes.value("class").toString().split(' ', QString::SkipEmptyParts).contains("trg")
+                                 || attributes.hasAttribute("lang");
+            if (translationDepth == 0 && isTranslation) {
+                translationDepth = depth;
+                translation.clear();
+            }
+        } else if (reader.isCharacters() && translationDepth != 0) {
+            translation += reader.text();
+        } else if (reader.isEndElement()) {
+            if (depth == translationDepth) {
+                definition.translations.append(translation);
+                translationDepth = 0;
+            }
+            depth--;
+        }
+    }
+    if (reader.hasError()) {
+        throw std::runtime_error("failed to parse apple dictionary definition: " + reader.errorString().toStdString());
+    }
+
+    if (definition.id.startsWith("f_")) {
+        definition.language = AppleDefinition::French;
+        definition.xml = xml;
+    } else if (definition.id.startsWith("e_")) {
+        definition.language = AppleDefinition::English;
+    }
+    return definition;
+}
@@ -0,0 +1,54 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_APPLEBODYREADER_H
+#define MEMENTO_APPLEBODYREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+struct AppleDefinition {
+    enum Language {
+        French,
+        English,
+        Unknown
+    };
+
+    Language language;
+    QString id;
+    QString title;
+    /* Only kept for French definitions, they are shown as is */
+    QByteArray xml;
+    /* Text of the outermost translation spans, they have the trg class or a lang attribute */
+    QStringList translations;
+};
+
+/**
+ * Reads the Body.data of the macOS French - English dictionary.
+ * The file is a run of zlib chunks, each holding many XML definitions. Chunks are decompressed and
+ * parsed on the thread pool while only a few of them are held in memory at once.
+ * Based off of https://gist.github.com/josephg/5e134adf70760ee7e49d
+ */
+class AppleBodyReader {
+
+public:
+    explicit AppleBodyReader(const QString &filename);
+
+    /* Calls handler on the calling thread with every definition, in file order */
+    void read(const std::function<void(const AppleDefinition &)> &handler);
+
+private:
+    static QVector<AppleDefinition> parseChunk(const QByteArray &compressed);
+    static QByteArray inflateChunk(const QByteArray &compressed);
+    static AppleDefinition parseDefinition(const QByteArray &xml);
+
+    QString filename;
+
+};
+
+
+#endif //MEMENTO_APPLEBODYREADER_H
@@ -0,0 +1,357 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "dictcompiler.h"
+#include "applebodyreader.h"
+#include "../dict/dawg.h"
+#include "../dict/dictionarylayer.h"
+#include "../dict/foldindex.h"
+#include "../dict/frenchprocessor.h"
+#include "../dict/glossindex.h"
+#include "../dict/perfecthash.h"
+#include "../dict/spellingindex.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSet>
+#include <QTextStream>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+
+/* A headword of the English to French side outweighs a word somewhere in a French definition */
+static const quint32 ENGLISH_HEADWORD_WEIGHT = 3;
+/* Too common to say anything about a definition */
+static const QSet<QString> STOP_WORDS{"a", "an", "and", "of", "or", "sb", "sth", "the", "to"};
+/* Between the French words of an English to French translation */
+static const QRegularExpression SEPARATORS("[,;]");
+
+DictCompiler::DictCompiler() {}
+
+quint32 DictCompiler::entryIndex(const QString &word) {
+    auto it = this->entryIndexes.constFind(word);
+    if (it != this->entryIndexes.constEnd()) {
+        return it.value();
+    }
+    quint32 index = this->entries.size();
+    this->entries.push_back(CompilerEntry{word, false, {}, {}});
+    this->entryIndexes.insert(word, index);
+    return index;
+}
+
+quint32 DictCompiler::intern(const QString &string) {
+    auto it = this->stringIndexes.constFind(string);
+    if (it != this->stringIndexes.constEnd()) {
+        return it.value();
+    }
+    quint32 index = this->strings.size();
+    this->strings.append(string);
+    this->stringIndexes.insert(string, index);
+    return index;
+}
+
+void DictCompiler::addGloss(const QString &english, const quint32 entry, const quint32 weight) {
+    for (const QString &token : GlossIndex::tokenize(english)) {
+        if (!STOP_WORDS.contains(token)) {
+            this->glossWeights[token.toUtf8()][entry] += weight;
+        }
+    }
+}
+
+void DictCompiler::readMlex(const QString &filename) {
+    // part of speech:
+    // https://web.archive.org/web/20200628045024/https://alpage.inria.fr/frmgwiki/content/tagset-frmg
+    // morphosyntactic tag: see `lefff-tagset-0.1.2.pdf` that comes with lefff mlex data
+    qInfo() << "read mlex file" << filename;
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly | QFile::Text)) {
+        throw std::runtime_error("failed to open mlex file " + filename.toStdString());
+    }
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    for (int lineNum = 1; !stream.atEnd(); lineNum++) {
+        QStringList fields = stream.readLine().split('\t');
+        if (fields.size() != 4) {
+            throw std::runtime_error("mlex line " + std::to_string(lineNum) + " does not have 4 fields");
+        }
+
+        QString word = FrenchProcessor::cleanWord(fields[0]);
+        if (!wordAllowed(word)) {
+            continue;
+        }
+        CompilerEntry &entry = this->entries[this->entryIndex(word)];
+        entry.exists = true;
+        entry.syntaxInfos.append(CompilerSyntaxInfo{this->intern(fields[1]), this->intern(FrenchProcessor::cleanWord(fields[2])), this->intern(fields[3])});
+    }
+}
+
+void DictCompiler::readAppleDict(const QString &filename) {
+    qInfo() << "read apple dictionary body from" << filename;
+    AppleBodyReader(filename).read(
+        [this](const AppleDefinition &definition) {
+            if (definition.language == AppleDefinition::French) {
+                QString word = FrenchProcessor::cleanWord(definition.title);
+                if (!wordAllowed(word)) {
+                    qWarning() << "word in apple dictionary not allowed," << definition.title;
+                    return;
+                }
+                quint32 index = this->entryIndex(word);
+                this->entries[index].exists = true;
+                this->entries[index].definitions.append(this->writer.addDefinition(definition.xml));
+                for (const QString &english : definition.translations) {
+                    this->addGloss(english, index, 1);
+                }
+            } else if (definition.language == AppleDefinition::English) {
+                // english to french definition, only used to search for french words by their english meaning
+                for (const QString &french : definition.translations) {
+                    for (const QString &word : french.split(SEPARATORS)) {
+                        this->addGloss(definition.title, this->entryIndex(FrenchProcessor::cleanWord(word.trimmed())), ENGLISH_HEADWORD_WEIGHT);
+                    }
+                }
+            } else {
+                qWarning() << "unknown language for definition id" << definition.id;
+            }
+        }
+    );
+}
+
+void DictCompiler::readGlossary(const QString &filename) {
+    qInfo() << "read glossary" << filename;
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly | QFile::Text)) {
+        throw std::runtime_error("failed to open glossary " + filename.toStdString());
+    }
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    for (int lineNum = 1; !stream.atEnd(); lineNum++) {
+        QString line = stream.readLine();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        int tab = line.indexOf('\t');
+        if (tab < 0) {
+            throw std::runtime_error("glossary line " + std::to_string(lineNum) + " has no tab");
+        }
+        QString headword = line.left(tab).trimmed();
+        QString definition = line.mid(tab + 1);
+
+        QString word = FrenchProcessor::cleanWord(headword);
+        if (!wordAllowed(word)) {
+            qWarning() << "glossary word not allowed," << headword;
+            continue;
+        }
+        quint32 index = this->entryIndex(word);
+        this->entries[index].exists = true;
+        QString html = "<div class=\"glossary\"><b>" + headword.toHtmlEscaped() + "</b> " + definition.toHtmlEscaped() + "</div>";
+        this->entries[index].definitions.append(this->writer.addDefinition(html.toUtf8()));
+        this->addGloss(definition, index, 1);
+    }
+}
+
+void DictCompiler::write(const QString &filename, const QString &spellingFilename) {
+    qInfo() << "write output to file" << filename;
+
+    QVector<quint32> existing;
+    QVector<quint64> hashes;
+    for (quint32 i = 0; i < this->entries.size(); i++) {
+        if (this->entries[i].exists) {
+            existing.append(i);
+            hashes.append(PerfectHash::hashKey(this->entries[i].word.toUtf8()));
+        }
+    }
+
+    // entries are stored in the order of their key's slot in the perfect hash
+    QVector<quint32> keySlots;
+    QByteArray perfectHash = PerfectHash::build(hashes, keySlots);
+    QVector<quint32> bySlot(existing.size());
+    QVector<quint32> slotOf(this->entries.size(), UINT32_MAX);
+    for (int i = 0; i < existing.size(); i++) {
+        bySlot[keySlots[i]] = existing[i];
+        slotOf[existing[i]] = keySlots[i];
+    }
+
+    QVector<QByteArray> keys;
+    keys.reserve(bySlot.size());
+    for (quint32 index : bySlot) {
+        keys.append(this->entries[index].word.toUtf8());
+    }
+
+    this->writeEntries(bySlot);
+
+    std::vector<std::pair<QByteArray, quint32>> sorted;
+    for (int slot = 0; slot < keys.size(); slot++) {
+        sorted.emplace_back(keys[slot], slot);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    QVector<QByteArray> sortedKeys;
+    QVector<quint32> rankToEntry;
+    for (const auto &[key, slot] : sorted) {
+        sortedKeys.append(key);
+        rankToEntry.append(slot);
+    }
+    QByteArray dawg = Dawg::build(sortedKeys, rankToEntry);
+
+    this->writer.write(filename, keys, {
+        {DICT_SECTION_PERFECT_HASH, perfectHash},
+        {DICT_SECTION_KEY_INDEX, dawg},
+        {DICT_SECTION_FOLD_INDEX, this->buildFoldIndex(bySlot)},
+        {DICT_SECTION_GLOSS_INDEX, this->buildGlossIndex(slotOf)}
+    });
+
+    // only loaded when a word has no match, so it goes in its own file
+    qInfo() << "write spelling index to file" << spellingFilename;
+    QVector<QString> words;
+    words.reserve(bySlot.size());
+    for (quint32 index : bySlot) {
+        words.append(this->entries[index].word);
+    }
+    QSaveFile spellingFile(spellingFilename);
+    if (!spellingFile.open(QIODevice::WriteOnly)) {
+        throw std::runtime_error("failed to open " + spellingFilename.toStdString() + " for writing");
+    }
+    spellingFile.write(SpellingIndex::build(words));
+    if (!spellingFile.commit()) {
+        throw std::runtime_error("failed to write " + spellingFilename.toStdString());
+    }
+
+    this->verify(filename, keys);
+}
+
+void DictCompiler::writeEntries(const QVector<quint32> &bySlot) {
+    // inflections are stored as (lemma, paradigm) pairs instead of full syntax infos
+    // a paradigm is a part of speech and the suffix rules that turn a lemma into each of its forms,
+    // shared by every lemma that inflects the same way
+    using Rule = std::tuple<int, QString, QString>; // strip, append, tag
+    std::map<std::pair<QString, QString>, std::set<Rule>> rulesByLemma; // (lemma, part of speech)
+    for (quint32 index : bySlot) {
+        const CompilerEntry &entry = this->entries[index];
+        for (const CompilerSyntaxInfo &info : entry.syntaxInfos) {
+            const QString &lemma = this->strings[info.lemma];
+            // remove this many characters from the end of the lemma, then append the rest of the word
+            int common = 0;
+            while (common < std::min(lemma.size(), entry.word.size()) && lemma[common] == entry.word[common]) {
+                common++;
+            }
+            rulesByLemma[{lemma, this->strings[info.partOfSpeech]}].emplace(lemma.size() - common, entry.word.mid(common), this->strings[info.morphosyntacticTag]);
+        }
+    }
+
+    // the map is ordered by lemma, so lemmas come out sorted
+    QStringList lemmas;
+    QHash<QString, quint32> lemmaIds;
+    for (const auto &pair : rulesByLemma) {
+        if (lemmas.isEmpty() || lemmas.last() != pair.first.first) {
+            lemmaIds.insert(pair.first.first, lemmas.size());
+            lemmas.append(pair.first.first);
+        }
+    }
+
+    QVector<Paradigm> paradigms;
+    std::map<std::pair<QString, std::vector<Rule>>, quint32> paradigmIds;
+    std::map<std::pair<QString, QString>, Inflection> inflections;
+    for (const auto &[lemmaAndPartOfSpeech, rules] : rulesByLemma) {
+        std::pair<QString, std::vector<Rule>> key{lemmaAndPartOfSpeech.second, std::vector<Rule>(rules.begin(), rules.end())};
+        auto it = paradigmIds.find(key);
+        if (it == paradigmIds.end()) {
+            Paradigm paradigm;
+            paradigm.partOfSpeech = key.first;
+            for (const auto &[strip, append, tag] : key.second) {
+                if (strip > UINT16_MAX) {
+                    throw std::runtime_error("inflection rule strips too many characters");
+                }
+                paradigm.rules.append(InflectionRule{(quint16) strip, append, tag});
+            }
+            it = paradigmIds.emplace(key, paradigms.size()).first;
+            paradigms.append(paradigm);
+        }
+        inflections[lemmaAndPartOfSpeech] = Inflection{lemmaIds[lemmaAndPartOfSpeech.first], it->second};
+    }
+
+    this->writer.beginEntries(lemmas, paradigms, bySlot.size());
+    for (quint32 index : bySlot) {
+        const CompilerEntry &entry = this->entries[index];
+        std::set<std::pair<quint32, quint32>> entryInflections;
+        for (const CompilerSyntaxInfo &info : entry.syntaxInfos) {
+            const Inflection &inflection = inflections[{this->strings[info.lemma], this->strings[info.partOfSpeech]}];
+            entryInflections.emplace(inflection.lemma, inflection.paradigm);
+        }
+        QVector<Inflection> out;
+        for (const auto &[lemma, paradigm] : entryInflections) {
+            out.append(Inflection{lemma, paradigm});
+        }
+        this->writer.addEntry(out, entry.definitions);
+    }
+}
+
+QByteArray DictCompiler::buildFoldIndex(const QVector<quint32> &bySlot) const {
+    std::map<QByteArray, QVector<quint32>> candidates;
+    for (int slot = 0; slot < bySlot.size(); slot++) {
+        const QString &word = this->entries[bySlot[slot]].word;
+        QString folded = FoldIndex::fold(word);
+        if (folded != word) {
+            candidates[folded.toUtf8()].append(slot);
+        }
+    }
+
+    // entries with definitions are the most useful guess, so they go first
+    auto order = [&](quint32 slot) {
+        const CompilerEntry &entry = this->entries[bySlot[slot]];
+        return std::make_tuple(entry.definitions.isEmpty(), entry.syntaxInfos.isEmpty(), entry.word);
+    };
+    QVector<QPair<QByteArray, QVector<quint32>>> folded;
+    for (auto &[key, entryIds] : candidates) {
+        std::sort(entryIds.begin(), entryIds.end(), [&](quint32 a, quint32 b) {
+            return order(a) < order(b);
+        });
+        folded.append({key, entryIds});
+    }
+    return FoldIndex::build(folded);
+}
+
+QByteArray DictCompiler::buildGlossIndex(const QVector<quint32> &slotOf) const {
+    // words only known from an English gloss have no entry and are dropped here
+    std::map<QByteArray, std::map<quint32, quint32>> postings;
+    for (auto term = this->glossWeights.constBegin(); term != this->glossWeights.constEnd(); ++term) {
+        for (auto weight = term.value().constBegin(); weight != term.value().constEnd(); ++weight) {
+            quint32 slot = slotOf[weight.key()];
+            if (slot != UINT32_MAX) {
+                postings[term.key()][slot] = weight.value();
+            }
+        }
+    }
+    return GlossIndex::build(postings);
+}
+
+void DictCompiler::verify(const QString &filename, const QVector<QByteArray> &keys) const {
+    // read back with the same code Memento uses, every key has to find its own entry
+    DictionaryLayer layer(filename);
+    for (int slot = 0; slot < keys.size(); slot++) {
+        if (layer.lookup(keys[slot], PerfectHash::hashKey(keys[slot])) != layer.entry(slot)) {
+            throw std::runtime_error("written dictionary does not find key " + keys[slot].toStdString());
+        }
+    }
+    layer.verifyDefinitions();
+    qInfo() << "checked" << keys.size() << "keys of" << filename;
+}
+
+bool DictCompiler::wordAllowed(const QString &wordLowercase) {
+    QString wordNoAccents = FoldIndex::fold(wordLowercase);
+
+    bool hasLetter = false;
+    for (int i = 0; i < wordNoAccents.size(); i++) {
+        QChar c = wordNoAccents[i];
+        if (c >= 'a' && c <= 'z') {
+            hasLetter = true;
+        } else if (QStringLiteral(" '-.").contains(c) && i > 0) {
+            // allow some punctuation if after first character
+        } else {
+            return false;
+        }
+    }
+    return hasLetter; // do not allow words with only punctuation
+}
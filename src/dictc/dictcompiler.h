@@ -0,0 +1,75 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMENTO_DICTCOMPILER_H
+#define MEMENTO_DICTCOMPILER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <vector>
+#include "../dict/dictwriter.h"
+
+/**
+ * Builds Memento's dictionary file from the lefff morphology, the macOS French - English dictionary
+ * or a glossary. Sources are streamed: definitions go straight into compressed blocks and only
+ * headwords, their inflections and gloss weights are kept until the indexes are written.
+ */
+class DictCompiler {
+
+public:
+    DictCompiler();
+
+    /* One "form<TAB>part of speech<TAB>lemma<TAB>tag" per line */
+    void readMlex(const QString &filename);
+    /* Body.data of the macOS French - English dictionary */
+    void readAppleDict(const QString &filename);
+    /* One "headword<TAB>definition" per line, for a layer over the base dictionary */
+    void readGlossary(const QString &filename);
+
+    /* Write the dictionary and its spelling index, then load the dictionary back to check it */
+    void write(const QString &filename, const QString &spellingFilename);
+
+private:
+    struct CompilerSyntaxInfo {
+        quint32 partOfSpeech;
+        quint32 lemma;
+        quint32 morphosyntacticTag;
+    };
+
+    struct CompilerEntry {
+        QString word;
+        /* False while the word is only known from an English gloss */
+        bool exists;
+        QVector<CompilerSyntaxInfo> syntaxInfos;
+        QList<DefinitionRef> definitions;
+    };
+
+    quint32 entryIndex(const QString &word);
+    quint32 intern(const QString &string);
+    void addGloss(const QString &english, quint32 entry, quint32 weight);
+
+    void writeEntries(const QVector<quint32> &bySlot);
+    QByteArray buildFoldIndex(const QVector<quint32> &bySlot) const;
+    QByteArray buildGlossIndex(const QVector<quint32> &slotOf) const;
+    void verify(const QString &filename, const QVector<QByteArray> &keys) const;
+
+    static bool wordAllowed(const QString &wordLowercase);
+
+    DictWriter writer;
+
+    std::vector<CompilerEntry> entries;
+    QHash<QString, quint32> entryIndexes;
+    /* Parts of speech, lemmas and tags repeat a lot, entries refer to them by index */
+    QStringList strings;
+    QHash<QString, quint32> stringIndexes;
+    /* term -> entry index -> weight */
+    QHash<QByteArray, QHash<quint32, quint32>> glossWeights;
+
+};
+
+
+#endif //MEMENTO_DICTCOMPILER_H
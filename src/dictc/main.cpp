@@ -0,0 +1,59 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "dictcompiler.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QThreadPool>
+#include <exception>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("memento-dictc");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Compile Memento's French dictionary file");
+    parser.addHelpOption();
+    QCommandLineOption mlexOption("mlex", "lefff morphology file.", "file", "lefff-3.4.mlex/lefff-3.4.mlex");
+    QCommandLineOption appleBodyOption("apple-body", "Body.data of the macOS French - English dictionary.", "file",
+                                       "AssetData/French - English.dictionary/Contents/Resources/Body.data");
+    QCommandLineOption glossaryOption("glossary", "Compile a glossary layer from a headword<TAB>definition file instead.", "file");
+    QCommandLineOption outputOption({"o", "output"}, "Dictionary file to write.", "file", "fren.dict");
+    QCommandLineOption spellingOption("spelling", "Spelling index to write, defaults to the output with .spell appended.", "file");
+    QCommandLineOption jobsOption({"j", "jobs"}, "Threads used to decompress the Apple dictionary.", "count");
+    parser.addOptions({mlexOption, appleBodyOption, glossaryOption, outputOption, spellingOption, jobsOption});
+    parser.process(app);
+
+    if (parser.isSet(jobsOption)) {
+        bool ok;
+        int jobs = parser.value(jobsOption).toInt(&ok);
+        if (!ok || jobs < 1) {
+            qCritical() << "invalid number of jobs" << parser.value(jobsOption);
+            return 1;
+        }
+        QThreadPool::globalInstance()->setMaxThreadCount(jobs);
+    }
+
+    QString output = parser.value(outputOption);
+    QString spelling = parser.isSet(spellingOption) ? parser.value(spellingOption) : output + ".spell";
+
+    try {
+        DictCompiler compiler;
+        if (parser.isSet(glossaryOption)) {
+            // goes in Memento's dictionaries directory
+            compiler.readGlossary(parser.value(glossaryOption));
+        } else {
+            compiler.readMlex(parser.value(mlexOption));
+            compiler.readAppleDict(parser.value(appleBodyOption));
+        }
+        compiler.write(output, spelling);
+    } catch (std::exception &e) {
+        qCritical() << "failed to compile dictionary:" << e.what();
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,192 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "audioclipper.h"
+
+#include "../util/globalmediator.h"
+
+extern "C"
+{
+#include <libavutil/mem.h>
+}
+
+#include <QDebug>
+#include <QFileInfo>
+#include <algorithm>
+#include <vector>
+
+AudioClipper::AudioClipper() : m_session(nullptr), m_track(0), m_stale(false)
+{
+    /* Direct, so a clip started on another thread never sees the old file once the player moved on.
+     * It does not wait for the lock, a long decode on the pool would freeze the interface */
+    m_fileChanged = QObject::connect(GlobalMediator::getGlobalMediator(), &GlobalMediator::playerFileChanged,
+        [=] {
+            m_stale = true;
+        }
+    );
+}
+
+AudioClipper::~AudioClipper()
+{
+    QObject::disconnect(m_fileChanged);
+    QMutexLocker locker(&m_lock);
+    close();
+}
+
+ClipSession *AudioClipper::session(const QString &inputFile, const size_t audioTrack)
+{
+    if (m_stale.exchange(false))
+    {
+        close();
+    }
+    if (m_session && m_file == inputFile && m_track == audioTrack)
+    {
+        return m_session;
+    }
+
+    close();
+    m_session = clip_session_open(inputFile.toUtf8().constData(), audioTrack);
+    if (m_session == nullptr)
+    {
+        qDebug() << "could not open" << inputFile << "to clip audio from";
+        return nullptr;
+    }
+    m_file = inputFile;
+    m_track = audioTrack;
+    return m_session;
+}
+
+void AudioClipper::close()
+{
+    clip_session_close(m_session);
+    m_session = nullptr;
+    m_file.clear();
+}
+
+void AudioClipper::count(const QString &path, const QString &extension)
+{
+    ClipStats &stats = m_stats[extension];
+    ++stats.clips;
+    stats.bytes += QFileInfo(path).size();
+}
+
+QString AudioClipper::clipAudio(const QString &inputFile, const size_t audioTrack, const QString &outputFile,
+                               const double start, const double end, const bool exact, const ClipFormat &format)
+{
+    const char *extension = clip_format_extension(&format);
+    if (extension == nullptr)
+    {
+        qDebug() << "unknown audio codec" << format.codec;
+        return QString();
+    }
+
+    QMutexLocker locker(&m_lock);
+    ClipSession *session = this->session(inputFile, audioTrack);
+    if (session == nullptr)
+    {
+        return QString();
+    }
+
+    const char *copyExtension = exact ? nullptr : clip_session_copy_extension(session, &format);
+    if (copyExtension)
+    {
+        const QString path = outputFile + copyExtension;
+        if (clip_session_remux(session, path.toUtf8().constData(), start, end) == 0)
+        {
+            count(path, copyExtension);
+            return copyExtension;
+        }
+        qDebug() << "could not copy the audio of" << inputFile << "transcoding it instead";
+    }
+
+    const QString path = outputFile + extension;
+    if (clip_session_transcode(session, path.toUtf8().constData(), &format, start, end))
+    {
+        close();
+        return QString();
+    }
+    count(path, extension);
+    return extension;
+}
+
+bool AudioClipper::transcode(const QString &inputFile, const size_t audioTrack, const ClipFormat &format,
+                             QList<Clip> &clips)
+{
+    std::stable_sort(clips.begin(), clips.end(), [] (const Clip &a, const Clip &b) { return a.start < b.start; });
+
+    QList<QByteArray> outputFiles;
+    std::vector<ClipInterval> intervals;
+    for (const Clip &clip : clips)
+    {
+        outputFiles.append(clip.outputFile.toUtf8());
+        intervals.push_back(ClipInterval{clip.start, clip.end, outputFiles.last().constData(), 0});
+    }
+
+    QMutexLocker locker(&m_lock);
+    ClipSession *session = this->session(inputFile, audioTrack);
+    if (session == nullptr)
+    {
+        return false;
+    }
+
+    int error = clip_session_transcode_batch(session, &format, intervals.data(), intervals.size());
+    for (int i = 0; i < clips.size(); ++i)
+    {
+        clips[i].success = intervals[i].result == 0;
+        if (clips[i].success)
+        {
+            count(clips[i].outputFile, clip_format_extension(&format));
+        }
+    }
+    if (error)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+QByteArray AudioClipper::decodePcm(const QString &inputFile, const size_t audioTrack,
+                                   const double start, const double end, int &sampleRate)
+{
+    QMutexLocker locker(&m_lock);
+    ClipSession *session = this->session(inputFile, audioTrack);
+    if (session == nullptr)
+    {
+        return QByteArray();
+    }
+
+    int16_t *samples = nullptr;
+    int numSamples = 0;
+    if (clip_session_decode_pcm(session, start, end, &samples, &numSamples, &sampleRate))
+    {
+        close();
+        return QByteArray();
+    }
+    QByteArray pcm(reinterpret_cast<const char *>(samples), numSamples * sizeof(int16_t));
+    av_free(samples);
+    return pcm;
+}
+
+QJsonObject AudioClipper::diagnostics()
+{
+    QMutexLocker locker(&m_lock);
+    QJsonObject formats;
+    ClipStats total;
+    for (auto it = m_stats.constBegin(); it != m_stats.constEnd(); ++it)
+    {
+        formats[it.key()] = QJsonObject{
+            {"clips", it->clips},
+            {"averageBytes", it->bytes / it->clips}
+        };
+        total.clips += it->clips;
+        total.bytes += it->bytes;
+    }
+    return QJsonObject{
+        {"clips", total.clips},
+        {"bytes", total.bytes},
+        {"averageBytes", total.clips ? total.bytes / total.clips : 0},
+        {"formats", formats}
+    };
+}
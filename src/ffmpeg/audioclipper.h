@@ -0,0 +1,91 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef AUDIOCLIPPER_H
+#define AUDIOCLIPPER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QMetaObject>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+
+extern "C"
+{
+#include "transcode_aac.h"
+}
+
+/**
+ * Clips audio out of the file that is playing. The file and its decoder stay open between clips
+ * and are closed by the next clip after the player loads another file. Thread safe, clips are made one at a time.
+ */
+class AudioClipper
+{
+public:
+    /* One clip of a batch */
+    struct Clip
+    {
+        double start;
+        double end;
+        QString outputFile;
+        /* Set by the batch */
+        bool success = false;
+    };
+
+    AudioClipper();
+    ~AudioClipper();
+
+    /**
+     * Clips the audio for a card. If the track already is in the format, its packets are copied from the one the
+     * start falls in, which can start a few milliseconds early. Otherwise or if it has to be exact it is transcoded.
+     * @param outputFile path of the clip without an extension
+     * @return The extension that was added to outputFile, empty if it failed
+     */
+    QString clipAudio(const QString &inputFile, const size_t audioTrack, const QString &outputFile,
+                      const double start, const double end, const bool exact, const ClipFormat &format);
+
+    /**
+     * Clips every interval to a file in the format, decoding the audio they cover once.
+     * Overlapping clips are fine, the clips are sorted by start time.
+     * @param clips their output files should end in the extension of the format
+     * @return false if decoding failed, each clip tells whether it was made
+     */
+    bool transcode(const QString &inputFile, const size_t audioTrack, const ClipFormat &format, QList<Clip> &clips);
+
+    /* Signed 16 bit mono samples at the sample rate of the track, empty if it failed */
+    QByteArray decodePcm(const QString &inputFile, const size_t audioTrack,
+                         const double start, const double end, int &sampleRate);
+
+    /* Number of clips made and their average size for each extension */
+    QJsonObject diagnostics();
+
+private:
+    /* Clips made and the bytes they take */
+    struct ClipStats
+    {
+        qint64 clips = 0;
+        qint64 bytes = 0;
+    };
+
+    QMutex m_lock;
+    ClipSession *m_session;
+    QString m_file;
+    size_t m_track;
+    QMetaObject::Connection m_fileChanged;
+    /* Set when the player loads another file, a clip may hold the lock so the session is closed by the next one */
+    std::atomic<bool> m_stale;
+    QHash<QString, ClipStats> m_stats;
+
+    /* Session for the track, the open one if it is the same. Call with the lock held */
+    ClipSession *session(const QString &inputFile, const size_t audioTrack);
+    /* Call with the lock held */
+    void close();
+    /* Counts a clip that was written. Call with the lock held */
+    void count(const QString &path, const QString &extension);
+};
+
+#endif // AUDIOCLIPPER_H
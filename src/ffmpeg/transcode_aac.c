@@ -43,10 +43,53 @@
 
 #include "libswresample/swresample.h"
 
-/* The output bit rate in bit/s */
-#define OUTPUT_BIT_RATE 96000
-/* The number of output channels */
-#define OUTPUT_CHANNELS 2
+/* Seconds between batched clips that are seeked over instead of decoded */
+#define BATCH_SEEK_GAP 10.0
+
+/** Codecs clips can be encoded with and the containers they are written in. */
+static const struct {
+    ClipCodec codec;
+    enum AVCodecID codec_id;
+    const char *container;
+    const char *extension;
+} clip_codecs[] = {
+    { CLIP_CODEC_AAC,  AV_CODEC_ID_AAC,  "adts", ".aac"  },
+    { CLIP_CODEC_OPUS, AV_CODEC_ID_OPUS, "ogg",  ".opus" },
+    { CLIP_CODEC_MP3,  AV_CODEC_ID_MP3,  "mp3",  ".mp3"  },
+};
+
+/**
+ * Find the codec and container of a clip format.
+ * @param format    The format of the clip
+ * @return Index into clip_codecs, -1 if the codec is unknown
+ */
+static int find_clip_codec(const ClipFormat *format)
+{
+    int i;
+    for (i = 0; i < FF_ARRAY_ELEMS(clip_codecs); ++i)
+        if (clip_codecs[i].codec == format->codec)
+            return i;
+    return -1;
+}
+
+/**
+ * Choose the sample rate closest to the wanted one that the encoder supports.
+ * @param codec         The encoder
+ * @param sample_rate   The wanted sample rate
+ * @return The sample rate to encode with
+ */
+static int choose_sample_rate(const AVCodec *codec, const int sample_rate)
+{
+    const int *rate;
+    int best = 0;
+
+    if (!codec->supported_samplerates)
+        return sample_rate;
+    for (rate = codec->supported_samplerates; *rate; ++rate)
+        if (!best || FFABS(*rate - sample_rate) < FFABS(best - sample_rate))
+            best = *rate;
+    return best;
+}
 
 /**
  * Open an input file and the required decoder.
@@ -141,6 +184,23 @@ static int open_input_file(const char *filename,
     return 0;
 }
 
+/**
+ * Convert seconds to a timestamp of a stream.
+ * @param stream    The stream the timestamp is for
+ * @param seconds   The time in seconds
+ * @return The timestamp in the time base of the stream
+ */
+static int64_t seconds_to_pts(const AVStream *stream, const double seconds)
+{
+    AVRational default_timebase = {
+        1,
+        AV_TIME_BASE
+    };
+    return av_rescale_q((int64_t)(seconds * AV_TIME_BASE),
+                        default_timebase,
+                        stream->time_base);
+}
+
 /**
  * Seek to the start location and populate the start and end positions.
  * @param      input_format_contex  The format context to seek through
@@ -158,16 +218,8 @@ static int seek_to_start(AVFormatContext *input_format_context,
 {
     /* Convert seconds to AV timestamp */
     const AVStream *stream = input_format_context->streams[audio_stream_idx];
-    AVRational default_timebase = {
-        1,
-        AV_TIME_BASE
-    };
-    *start_pts = av_rescale_q((int64_t)(start * AV_TIME_BASE), 
-                              default_timebase, 
-                              stream->time_base);
-    *end_pts   = av_rescale_q((int64_t)(end * AV_TIME_BASE), 
-                              default_timebase, 
-                              stream->time_base);
+    *start_pts = seconds_to_pts(stream, start);
+    *end_pts   = seconds_to_pts(stream, end);
 
     /* Seek to the starting point */
     av_seek_frame(input_format_context, audio_stream_idx, *start_pts, 0);
@@ -176,24 +228,18 @@ static int seek_to_start(AVFormatContext *input_format_context,
 }
 
 /**
- * Open an output file and the required encoder.
- * Also set some basic encoder parameters.
- * Some of these parameters are based on the input file's parameters.
+ * Open an output file and its container format.
  * @param      filename              File to be opened
- * @param      input_codec_context   Codec context of input file
+ * @param      container_name        Short name of the container format,
+ *                                   NULL to guess it from the file extension
  * @param[out] output_format_context Format context of output file
- * @param[out] output_codec_context  Codec context of output file
  * @return Error code (0 if successful)
  */
-static int open_output_file(const char *filename,
-                            AVCodecContext *input_codec_context,
-                            AVFormatContext **output_format_context,
-                            AVCodecContext **output_codec_context)
+static int open_output_container(const char *filename,
+                                 const char *container_name,
+                                 AVFormatContext **output_format_context)
 {
-    AVCodecContext *avctx          = NULL;
     AVIOContext *output_io_context = NULL;
-    AVStream *stream               = NULL;
-    AVCodec *output_codec          = NULL;
     int error;
 
     /* Open the output file to write to it. */
@@ -207,14 +253,16 @@ static int open_output_file(const char *filename,
     /* Create a new format context for the output container format. */
     if (!(*output_format_context = avformat_alloc_context())) {
         fprintf(stderr, "Could not allocate output format context\n");
+        avio_closep(&output_io_context);
         return AVERROR(ENOMEM);
     }
 
     /* Associate the output file (pointer) with the container format context. */
     (*output_format_context)->pb = output_io_context;
 
-    /* Guess the desired container format based on the file extension. */
-    if (!((*output_format_context)->oformat = av_guess_format(NULL, filename,
+    /* Find the container format by its name or the file extension. */
+    if (!((*output_format_context)->oformat = av_guess_format(container_name,
+                                                              filename,
                                                               NULL))) {
         fprintf(stderr, "Could not find output file format\n");
         goto cleanup;
@@ -226,9 +274,53 @@ static int open_output_file(const char *filename,
         goto cleanup;
     }
 
-    /* Find the encoder to be used by its name. */
-    if (!(output_codec = avcodec_find_encoder(AV_CODEC_ID_AAC))) {
-        fprintf(stderr, "Could not find an AAC encoder.\n");
+    return 0;
+
+cleanup:
+    avio_closep(&(*output_format_context)->pb);
+    avformat_free_context(*output_format_context);
+    *output_format_context = NULL;
+    return error < 0 ? error : AVERROR_EXIT;
+}
+
+/**
+ * Open an output file and the required encoder.
+ * Also set some basic encoder parameters.
+ * Some of these parameters are based on the input file's parameters.
+ * @param      filename              File to be opened
+ * @param      input_codec_context   Codec context of input file
+ * @param      format                Format of the output
+ * @param[out] output_format_context Format context of output file
+ * @param[out] output_codec_context  Codec context of output file
+ * @return Error code (0 if successful)
+ */
+static int open_output_file(const char *filename,
+                            AVCodecContext *input_codec_context,
+                            const ClipFormat *format,
+                            AVFormatContext **output_format_context,
+                            AVCodecContext **output_codec_context)
+{
+    AVCodecContext *avctx          = NULL;
+    AVStream *stream               = NULL;
+    AVCodec *output_codec          = NULL;
+    const int codec_idx            = find_clip_codec(format);
+    int error;
+
+    if (codec_idx < 0) {
+        fprintf(stderr, "Unknown output codec %d\n", format->codec);
+        return AVERROR_EXIT;
+    }
+
+    /* Open the output file and the container of the codec. */
+    if ((error = open_output_container(filename, clip_codecs[codec_idx].container,
+                                       output_format_context)) < 0)
+        return error;
+
+    /* Find an encoder for the codec, the ones that are not experimental
+     * come first. */
+    if (!(output_codec = avcodec_find_encoder(clip_codecs[codec_idx].codec_id))) {
+        fprintf(stderr, "Could not find an encoder for %s.\n",
+                avcodec_get_name(clip_codecs[codec_idx].codec_id));
         goto cleanup;
     }
 
@@ -247,19 +339,23 @@ static int open_output_file(const char *filename,
     }
 
     /* Set the basic encoder parameters.
-     * The input file's sample rate is used to avoid a sample rate conversion. */
-    avctx->channels       = OUTPUT_CHANNELS;
-    avctx->channel_layout = av_get_default_channel_layout(OUTPUT_CHANNELS);
-    avctx->sample_rate    = input_codec_context->sample_rate;
+     * Without a sample rate in the format, the input file's sample rate is
+     * used to avoid a sample rate conversion if the encoder supports it. */
+    avctx->channels       = format->channels;
+    avctx->channel_layout = av_get_default_channel_layout(format->channels);
+    avctx->sample_rate    = choose_sample_rate(output_codec,
+                                               format->sample_rate ? format->sample_rate
+                                                                   : input_codec_context->sample_rate);
     avctx->sample_fmt     = output_codec->sample_fmts[0];
-    avctx->bit_rate       = OUTPUT_BIT_RATE;
+    avctx->bit_rate       = format->bit_rate;
 
-    /* Allow the use of the experimental AAC encoder. */
+    /* Allow the use of experimental encoders. */
     avctx->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;
 
     /* Set the sample rate for the container. */
-    stream->time_base.den = input_codec_context->sample_rate;
+    stream->time_base.den = avctx->sample_rate;
     stream->time_base.num = 1;
+    avctx->time_base      = stream->time_base;
 
     /* Some container formats (like MP4) require global headers to be present.
      * Mark the encoder so that it behaves accordingly. */
@@ -354,12 +450,6 @@ static int init_resampler(AVCodecContext *input_codec_context,
             fprintf(stderr, "Could not allocate resample context\n");
             return AVERROR(ENOMEM);
         }
-        /*
-        * Perform a sanity check so that the number of converted samples is
-        * not greater than the number of samples to be converted.
-        * If the sample rates differ, this case has to be handled differently
-        */
-        av_assert0(output_codec_context->sample_rate == input_codec_context->sample_rate);
 
         /* Open the resampler with the specified parameters. */
         if ((error = swr_init(*resample_context)) < 0) {
@@ -536,33 +626,35 @@ static int init_converted_samples(uint8_t ***converted_input_samples,
 }
 
 /**
- * Convert the input audio samples into the output sample format.
+ * Convert the input audio samples into the output sample format and rate.
  * The conversion happens on a per-frame basis, the size of which is
- * specified by frame_size.
+ * specified by input_size. When the sample rate changes, the resampler
+ * holds some samples back until the next call.
  * @param      input_data       Samples to be decoded. The dimensions are
  *                              channel (for multi-channel audio), sample.
+ *                              NULL takes the samples held back.
+ * @param      input_size       Number of samples to be converted
  * @param[out] converted_data   Converted samples. The dimensions are channel
  *                              (for multi-channel audio), sample.
- * @param      frame_size       Number of samples to be converted
+ * @param      output_size      Number of samples converted_data can hold
  * @param      resample_context Resample context for the conversion
- * @return Error code (0 if successful)
+ * @return Number of converted samples, or error code (negative)
  */
-static int convert_samples(const uint8_t **input_data,
-                           uint8_t **converted_data, const int frame_size,
+static int convert_samples(const uint8_t **input_data, const int input_size,
+                           uint8_t **converted_data, const int output_size,
                            SwrContext *resample_context)
 {
-    int error;
+    int converted;
 
     /* Convert the samples using the resampler. */
-    if ((error = swr_convert(resample_context,
-                             converted_data, frame_size,
-                             input_data    , frame_size)) < 0) {
+    if ((converted = swr_convert(resample_context,
+                                 converted_data, output_size,
+                                 input_data    , input_size)) < 0) {
         fprintf(stderr, "Could not convert input samples (error '%s')\n",
-                av_err2str(error));
-        return error;
+                av_err2str(converted));
     }
 
-    return 0;
+    return converted;
 }
 
 /**
@@ -648,20 +740,26 @@ static int read_decode_convert_and_store(AVAudioFifo *fifo,
     }
     /* If there is decoded data, convert and store it. */
     if (data_present) {
+        /* Resampling can give a few more samples than it is given. */
+        const int output_size = swr_get_out_samples(resampler_context,
+                                                    input_frame->nb_samples);
+        int converted;
+
         /* Initialize the temporary storage for the converted input samples. */
         if (init_converted_samples(&converted_input_samples, output_codec_context,
-                                   input_frame->nb_samples))
+                                   output_size))
             goto cleanup;
 
         /* Convert the input samples to the desired output sample format.
          * This requires a temporary storage provided by converted_input_samples. */
-        if (convert_samples((const uint8_t**)input_frame->extended_data, converted_input_samples,
-                            input_frame->nb_samples, resampler_context))
+        if ((converted = convert_samples((const uint8_t**)input_frame->extended_data,
+                                         input_frame->nb_samples,
+                                         converted_input_samples, output_size,
+                                         resampler_context)) < 0)
             goto cleanup;
 
         /* Add the converted input samples to the FIFO buffer for later processing. */
-        if (add_samples_to_fifo(fifo, converted_input_samples,
-                                input_frame->nb_samples))
+        if (add_samples_to_fifo(fifo, converted_input_samples, converted))
             goto cleanup;
         ret = 0;
     }
@@ -677,6 +775,41 @@ cleanup:
     return ret;
 }
 
+/**
+ * Convert the samples the resampler held back and store them in the FIFO
+ * buffer, for the end of the input.
+ * @param fifo                 Buffer used for temporary storage
+ * @param output_codec_context Codec context of the output file
+ * @param resampler_context    Resample context for the conversion
+ * @return Error code (0 if successful)
+ */
+static int flush_resampler(AVAudioFifo *fifo,
+                           AVCodecContext *output_codec_context,
+                           SwrContext *resampler_context)
+{
+    const int output_size = swr_get_out_samples(resampler_context, 0);
+    uint8_t **converted_samples = NULL;
+    int converted;
+    int ret = AVERROR_EXIT;
+
+    if (output_size <= 0)
+        return 0;
+    if (init_converted_samples(&converted_samples, output_codec_context,
+                               output_size))
+        return AVERROR_EXIT;
+    if ((converted = convert_samples(NULL, 0, converted_samples, output_size,
+                                     resampler_context)) < 0)
+        goto cleanup;
+    if (add_samples_to_fifo(fifo, converted_samples, converted))
+        goto cleanup;
+    ret = 0;
+
+cleanup:
+    av_freep(&converted_samples[0]);
+    free(converted_samples);
+    return ret;
+}
+
 /**
  * Initialize one input frame for writing to the output file.
  * The frame will be exactly frame_size samples large.
@@ -781,6 +914,17 @@ static int encode_audio_frame(AVFrame *frame, int64_t *pts,
         *data_present = 1;
     }
 
+    /* The frames are timed in samples, the muxer may have picked another
+     * time base for the stream while writing the header, e.g. Ogg always
+     * times Opus at 48 kHz. */
+    if (*data_present) {
+        AVRational codec_time_base = output_codec_context->time_base;
+        if (!codec_time_base.num || !codec_time_base.den)
+            codec_time_base = (AVRational){ 1, output_codec_context->sample_rate };
+        av_packet_rescale_ts(output_packet, codec_time_base,
+                             output_format_context->streams[0]->time_base);
+    }
+
     /* Write one audio frame from the temporary packet to the output file. */
     if (*data_present &&
         (error = av_write_frame(output_format_context, output_packet)) < 0) {
@@ -855,43 +999,145 @@ static int write_output_file_trailer(AVFormatContext *output_format_context)
 }
 
 /**
- * Clip the audio from an input file to an AAC output file.
+ * An input file kept open between clips, so each clip only seeks, decodes
+ * and encodes.
+ */
+struct ClipSession {
+    AVFormatContext *input_format_context;
+    AVCodecContext *input_codec_context;
+    size_t audio_stream_idx;
+    /* Made by the first clip that needs them. The resampler for encoding
+     * is kept while the output format stays the same. */
+    SwrContext *resample_context;
+    enum AVSampleFormat resample_sample_fmt;
+    int resample_sample_rate;
+    int resample_channels;
+    SwrContext *pcm_resample_context;
+};
+
+/**
+ * Open an input file and its decoder to clip from.
  * @param input_file    The file to read audio streams from.
- * @param output_file   The output file.
  * @param audio_track   Index of the audio stream to clip. Starts from 0.
+ * @return The session, NULL if the file could not be opened
+ */
+ClipSession *clip_session_open(const char *input_file,
+                               const size_t audio_track)
+{
+    ClipSession *session = av_mallocz(sizeof(*session));
+    if (!session) {
+        fprintf(stderr, "Could not allocate clip session\n");
+        return NULL;
+    }
+
+    /* Open the input file for reading. */
+    if (open_input_file(input_file, audio_track, &session->audio_stream_idx,
+                        &session->input_format_context,
+                        &session->input_codec_context)) {
+        clip_session_close(session);
+        return NULL;
+    }
+    return session;
+}
+
+/**
+ * Close the input file and free the session.
+ * @param session   The session to close, may be NULL.
+ */
+void clip_session_close(ClipSession *session)
+{
+    if (!session)
+        return;
+    swr_free(&session->resample_context);
+    swr_free(&session->pcm_resample_context);
+    if (session->input_codec_context)
+        avcodec_free_context(&session->input_codec_context);
+    if (session->input_format_context)
+        avformat_close_input(&session->input_format_context);
+    av_free(session);
+}
+
+/**
+ * Seek the session to a clip. The decoder may still hold frames from the
+ * previous clip or be drained at the end of the file, so it is flushed.
+ * @param      session      The session to seek
+ * @param      start        The starting time
+ * @param      end          The ending time
+ * @param[out] start_pts    The starting position
+ * @param[out] end_pts      The ending position
+ * @return Error code (0 if successful)
+ */
+static int seek_session(ClipSession *session,
+                        const double start, const double end,
+                        int64_t *start_pts, int64_t *end_pts)
+{
+    avcodec_flush_buffers(session->input_codec_context);
+    return seek_to_start(session->input_format_context,
+                         session->audio_stream_idx, start, end,
+                         start_pts, end_pts);
+}
+
+/**
+ * Prepare the resampler of the session for an output. It is made again if
+ * the output format changed, otherwise the samples it held back from the
+ * last clip are dropped.
+ * @param session               The session to resample in
+ * @param output_codec_context  Codec context of the output file
+ * @return Error code (0 if successful)
+ */
+static int init_session_resampler(ClipSession *session,
+                                  AVCodecContext *output_codec_context)
+{
+    if (session->resample_context &&
+        session->resample_sample_fmt  == output_codec_context->sample_fmt &&
+        session->resample_sample_rate == output_codec_context->sample_rate &&
+        session->resample_channels    == output_codec_context->channels) {
+        swr_close(session->resample_context);
+        return swr_init(session->resample_context);
+    }
+
+    swr_free(&session->resample_context);
+    if (init_resampler(session->input_codec_context, output_codec_context,
+                       &session->resample_context))
+        return AVERROR_EXIT;
+    session->resample_sample_fmt  = output_codec_context->sample_fmt;
+    session->resample_sample_rate = output_codec_context->sample_rate;
+    session->resample_channels    = output_codec_context->channels;
+    return 0;
+}
+
+/**
+ * Clip the audio of an open input file to an output file.
+ * @param session       The open input file.
+ * @param output_file   The output file, its extension should come from
+ *                      clip_format_extension.
+ * @param format        Format of the output.
  * @param start         Start time of the clip.
  * @param end           End time of the clip.
  * @return Error code (0 if successful)
  */
-int transcode_aac(const char *input_file, const char *output_file,
-                  const size_t audio_track,
-                  const double start, const double end)
+int clip_session_transcode(ClipSession *session, const char *output_file,
+                           const ClipFormat *format,
+                           const double start, const double end)
 {
-    size_t audio_stream_idx = 0;
     int64_t start_pts = 0, end_pts = 0, pts = 0;
-    AVFormatContext *input_format_context = NULL, *output_format_context = NULL;
-    AVCodecContext *input_codec_context = NULL, *output_codec_context = NULL;
-    SwrContext *resample_context = NULL;
+    AVFormatContext *input_format_context = session->input_format_context;
+    AVCodecContext *input_codec_context = session->input_codec_context;
+    const size_t audio_stream_idx = session->audio_stream_idx;
+    AVFormatContext *output_format_context = NULL;
+    AVCodecContext *output_codec_context = NULL;
     AVAudioFifo *fifo = NULL;
     int ret = AVERROR_EXIT;
-    //input_codec_context->time_base;
 
-    /* Open the input file for reading. */
-    if (open_input_file(input_file, audio_track, &audio_stream_idx,
-                        &input_format_context, &input_codec_context))
-        goto cleanup;
     /* Seek to about the position and set the start and end postion */
-    if (seek_to_start(input_format_context,
-                      audio_stream_idx, start, end,
-                      &start_pts, &end_pts))
+    if (seek_session(session, start, end, &start_pts, &end_pts))
         goto cleanup;
     /* Open the output file for writing. */
-    if (open_output_file(output_file, input_codec_context,
+    if (open_output_file(output_file, input_codec_context, format,
                          &output_format_context, &output_codec_context))
         goto cleanup;
     /* Initialize the resampler to be able to convert audio sample formats. */
-    if (init_resampler(input_codec_context, output_codec_context,
-                       &resample_context))
+    if (init_session_resampler(session, output_codec_context))
         goto cleanup;
     /* Initialize the FIFO buffer to store audio samples to be encoded. */
     if (init_fifo(&fifo, output_codec_context))
@@ -920,7 +1166,8 @@ int transcode_aac(const char *input_file, const char *output_file,
                                               audio_stream_idx,
                                               start_pts, end_pts,
                                               output_codec_context,
-                                              resample_context, &finished))
+                                              session->resample_context,
+                                              &finished))
                 goto cleanup;
 
             /* If we are at the end of the input file, we continue
@@ -929,6 +1176,11 @@ int transcode_aac(const char *input_file, const char *output_file,
                 break;
         }
 
+        /* At the end, take the samples the resampler held back. */
+        if (finished &&
+            flush_resampler(fifo, output_codec_context, session->resample_context))
+            goto cleanup;
+
         /* If we have enough samples for the encoder, we encode them.
          * At the end of the file, we pass the remaining samples to
          * the encoder. */
@@ -963,17 +1215,533 @@ int transcode_aac(const char *input_file, const char *output_file,
 cleanup:
     if (fifo)
         av_audio_fifo_free(fifo);
-    swr_free(&resample_context);
     if (output_codec_context)
         avcodec_free_context(&output_codec_context);
     if (output_format_context) {
         avio_closep(&output_format_context->pb);
         avformat_free_context(output_format_context);
     }
-    if (input_codec_context)
-        avcodec_free_context(&input_codec_context);
-    if (input_format_context)
-        avformat_close_input(&input_format_context);
+
+    return ret;
+}
+
+/** The state of one output of a batch. */
+typedef struct BatchOutput {
+    enum {
+        BATCH_PENDING,
+        BATCH_ACTIVE,
+        BATCH_DONE
+    } state;
+    int64_t start_pts, end_pts, pts;
+    AVFormatContext *format_context;
+    AVCodecContext *codec_context;
+    AVAudioFifo *fifo;
+} BatchOutput;
+
+/**
+ * Free an output of a batch, the file is left as it is.
+ * @param output    The output to close
+ */
+static void close_batch_output(BatchOutput *output)
+{
+    if (output->fifo)
+        av_audio_fifo_free(output->fifo);
+    output->fifo = NULL;
+    if (output->codec_context)
+        avcodec_free_context(&output->codec_context);
+    if (output->format_context) {
+        avio_closep(&output->format_context->pb);
+        avformat_free_context(output->format_context);
+        output->format_context = NULL;
+    }
+    output->state = BATCH_DONE;
+}
+
+/**
+ * Open the output file and encoder of a batched clip and write its header.
+ * @param session           The open input file
+ * @param output_file       The output file
+ * @param format            Format of the output
+ * @param reset_resampler   Whether to prepare the resampler, the clips of a
+ *                          batch share it so it is only done while none of
+ *                          them is open
+ * @param output            The output to open
+ * @return Error code (0 if successful)
+ */
+static int open_batch_output(ClipSession *session, const char *output_file,
+                             const ClipFormat *format,
+                             const int reset_resampler,
+                             BatchOutput *output)
+{
+    output->state = BATCH_ACTIVE;
+    output->pts = 0;
+    if (open_output_file(output_file, session->input_codec_context, format,
+                         &output->format_context, &output->codec_context))
+        return AVERROR_EXIT;
+    if (reset_resampler &&
+        init_session_resampler(session, output->codec_context))
+        return AVERROR_EXIT;
+    if (init_fifo(&output->fifo, output->codec_context))
+        return AVERROR_EXIT;
+    if (write_output_file_header(output->format_context))
+        return AVERROR_EXIT;
+    return 0;
+}
+
+/**
+ * Encode the samples left in the FIFO buffer of a batched clip, flush its
+ * encoder and write the trailer.
+ * @param output    The output to finish
+ * @return Error code (0 if successful)
+ */
+static int finish_batch_output(BatchOutput *output)
+{
+    int data_written;
+
+    while (av_audio_fifo_size(output->fifo) > 0)
+        if (load_encode_and_write(output->fifo, &output->pts,
+                                  output->format_context,
+                                  output->codec_context))
+            return AVERROR_EXIT;
+    /* Flush the encoder as it may have delayed frames. */
+    do {
+        data_written = 0;
+        if (encode_audio_frame(NULL, &output->pts, output->format_context,
+                               output->codec_context, &data_written))
+            return AVERROR_EXIT;
+    } while (data_written);
+    return write_output_file_trailer(output->format_context);
+}
+
+/**
+ * Clip several intervals of an open input file to output files while
+ * decoding the covered audio only once, front to back. Every decoded frame
+ * is converted once and then encoded by each clip it belongs to, so
+ * overlapping clips share the decoding. Gaps between clips longer than
+ * BATCH_SEEK_GAP are seeked over.
+ * @param session       The open input file.
+ * @param format        Format of the outputs.
+ * @param clips         The clips sorted by start time. The result of each
+ *                      is set.
+ * @param num_clips     The number of clips.
+ * @return Error code of decoding (0 if successful)
+ */
+int clip_session_transcode_batch(ClipSession *session, const ClipFormat *format,
+                                 ClipInterval *clips, const size_t num_clips)
+{
+    const AVStream *stream = session->input_format_context->streams[session->audio_stream_idx];
+    BatchOutput *outputs = NULL;
+    AVFrame *input_frame = NULL;
+    /* Clips before first are done, clips from next on are pending. */
+    size_t first = 0, next = 0, i;
+    int64_t start_pts, end_pts, position = AV_NOPTS_VALUE;
+    int any_active;
+    int finished = 0;
+    int ret = AVERROR_EXIT;
+
+    for (i = 0; i < num_clips; ++i)
+        clips[i].result = AVERROR_EXIT;
+    if (num_clips == 0)
+        return 0;
+
+    if (!(outputs = av_calloc(num_clips, sizeof(*outputs)))) {
+        fprintf(stderr, "Could not allocate batch outputs\n");
+        return AVERROR(ENOMEM);
+    }
+    for (i = 0; i < num_clips; ++i) {
+        outputs[i].state     = BATCH_PENDING;
+        outputs[i].start_pts = seconds_to_pts(stream, clips[i].start);
+        outputs[i].end_pts   = seconds_to_pts(stream, clips[i].end);
+    }
+    if (init_input_frame(&input_frame))
+        goto cleanup;
+
+    while (first < num_clips && !finished) {
+        int data_present = 0;
+        int64_t pts;
+
+        /* Nothing is being clipped and the next clip is far away. */
+        if (first == next &&
+            (position == AV_NOPTS_VALUE ||
+             outputs[next].start_pts - position >
+             seconds_to_pts(stream, BATCH_SEEK_GAP))) {
+            if (seek_session(session, clips[next].start, clips[next].end,
+                             &start_pts, &end_pts))
+                goto cleanup;
+            position = start_pts;
+        }
+
+        /* Packets before the earliest clip that is not done are skipped. */
+        if (decode_audio_frame(input_frame, session->input_format_context,
+                               session->input_codec_context,
+                               session->audio_stream_idx,
+                               outputs[first].start_pts, INT64_MAX,
+                               &data_present, &finished))
+            goto cleanup;
+        if (finished || !data_present)
+            continue;
+        pts = input_frame->best_effort_timestamp;
+        if (pts == AV_NOPTS_VALUE)
+            continue;
+        position = pts;
+
+        /* Like a single clip, a clip ends before the first frame at its end. */
+        for (i = first; i < next; ++i)
+            if (outputs[i].state == BATCH_ACTIVE && pts >= outputs[i].end_pts) {
+                clips[i].result = finish_batch_output(&outputs[i]);
+                close_batch_output(&outputs[i]);
+            }
+        /* Open the clips that start at this frame. */
+        any_active = 0;
+        for (i = first; i < next; ++i)
+            any_active |= outputs[i].state == BATCH_ACTIVE;
+        while (next < num_clips && pts >= outputs[next].start_pts) {
+            if (open_batch_output(session, clips[next].output_file, format,
+                                  !any_active, &outputs[next]))
+                close_batch_output(&outputs[next]);
+            else if (pts >= outputs[next].end_pts) {
+                /* Shorter than a frame, it is left empty. */
+                clips[next].result = finish_batch_output(&outputs[next]);
+                close_batch_output(&outputs[next]);
+            } else
+                any_active = 1;
+            ++next;
+        }
+        while (first < next && outputs[first].state == BATCH_DONE)
+            ++first;
+
+        /* Convert the frame once and pass it to every clip it is in. The
+         * samples the resampler holds back at the end of a clip are left out. */
+        if (first < next) {
+            const int output_size = swr_get_out_samples(session->resample_context,
+                                                        input_frame->nb_samples);
+            uint8_t **converted_input_samples = NULL;
+            int converted;
+
+            if (init_converted_samples(&converted_input_samples,
+                                       outputs[first].codec_context,
+                                       output_size))
+                goto cleanup;
+            converted = convert_samples((const uint8_t **)input_frame->extended_data,
+                                        input_frame->nb_samples,
+                                        converted_input_samples, output_size,
+                                        session->resample_context);
+            for (i = first; converted >= 0 && i < next; ++i) {
+                BatchOutput *output = &outputs[i];
+                if (output->state != BATCH_ACTIVE)
+                    continue;
+                if (add_samples_to_fifo(output->fifo, converted_input_samples,
+                                        converted)) {
+                    close_batch_output(output);
+                    continue;
+                }
+                /* Encode every full frame, the rest waits for more samples. */
+                while (av_audio_fifo_size(output->fifo) >= output->codec_context->frame_size)
+                    if (load_encode_and_write(output->fifo, &output->pts,
+                                              output->format_context,
+                                              output->codec_context)) {
+                        close_batch_output(output);
+                        break;
+                    }
+            }
+            av_freep(&converted_input_samples[0]);
+            free(converted_input_samples);
+            if (converted < 0)
+                goto cleanup;
+        }
+    }
+
+    /* At the end of the file the clips still open end with it, clips that
+     * start after it are left empty like a single clip would be. */
+    for (i = first; i < num_clips; ++i) {
+        if (outputs[i].state == BATCH_PENDING &&
+            open_batch_output(session, clips[i].output_file, format, 0,
+                              &outputs[i])) {
+            close_batch_output(&outputs[i]);
+            continue;
+        }
+        if (outputs[i].state == BATCH_ACTIVE) {
+            clips[i].result = finish_batch_output(&outputs[i]);
+            close_batch_output(&outputs[i]);
+        }
+    }
+    ret = 0;
+
+cleanup:
+    for (i = 0; i < num_clips; ++i)
+        close_batch_output(&outputs[i]);
+    av_free(outputs);
+    av_frame_free(&input_frame);
+
+    return ret;
+}
+
+/**
+ * Find the file extension of the format of a clip.
+ * @param format    The format of the clip.
+ * @return The extension including the dot, NULL if the codec is unknown
+ */
+const char *clip_format_extension(const ClipFormat *format)
+{
+    const int codec_idx = find_clip_codec(format);
+    return codec_idx < 0 ? NULL : clip_codecs[codec_idx].extension;
+}
+
+/**
+ * Check whether the audio track already is in the format of a clip, so it
+ * can be copied instead of transcoded.
+ * @param session   The open input file.
+ * @param format    The format of the clip.
+ * @return The extension including the dot, NULL if the track has to be
+ *         transcoded
+ */
+const char *clip_session_copy_extension(ClipSession *session,
+                                        const ClipFormat *format)
+{
+    const AVCodecParameters *codecpar =
+        session->input_format_context->streams[session->audio_stream_idx]->codecpar;
+    const int codec_idx = find_clip_codec(format);
+
+    if (codec_idx < 0 || codecpar->codec_id != clip_codecs[codec_idx].codec_id)
+        return NULL;
+    /* A copy must not be bigger than the format allows, an unknown bit rate
+     * is trusted. */
+    if (codecpar->channels > format->channels ||
+        (codecpar->bit_rate > 0 && codecpar->bit_rate > format->bit_rate) ||
+        (format->sample_rate && codecpar->sample_rate != format->sample_rate))
+        return NULL;
+    return clip_codecs[codec_idx].extension;
+}
+
+/**
+ * Copy the packets of the audio track between start and end to an output
+ * file without decoding them. The clip begins with the packet the start
+ * falls in, so it can start up to one packet early. The timestamps are
+ * rebased so the clip starts at 0.
+ * @param session       The open input file.
+ * @param output_file   The output file, its extension should come from
+ *                      clip_session_copy_extension.
+ * @param start         Start time of the clip.
+ * @param end           End time of the clip.
+ * @return Error code (0 if successful)
+ */
+int clip_session_remux(ClipSession *session, const char *output_file,
+                       const double start, const double end)
+{
+    AVFormatContext *input_format_context = session->input_format_context;
+    const size_t audio_stream_idx = session->audio_stream_idx;
+    AVStream *input_stream = input_format_context->streams[audio_stream_idx];
+    AVFormatContext *output_format_context = NULL;
+    AVStream *output_stream = NULL;
+    AVPacket *packet = NULL;
+    const int64_t start_pts = seconds_to_pts(input_stream, start);
+    const int64_t end_pts   = seconds_to_pts(input_stream, end);
+    int64_t first_pts = AV_NOPTS_VALUE;
+    int error;
+    int ret = AVERROR_EXIT;
+
+    /* Seek to the packet at or before the start. */
+    if ((error = av_seek_frame(input_format_context, audio_stream_idx,
+                               start_pts, AVSEEK_FLAG_BACKWARD)) < 0) {
+        fprintf(stderr, "Could not seek to the start (error '%s')\n",
+                av_err2str(error));
+        goto cleanup;
+    }
+
+    if (open_output_container(output_file, NULL, &output_format_context))
+        goto cleanup;
+    if (!(output_stream = avformat_new_stream(output_format_context, NULL))) {
+        fprintf(stderr, "Could not create new stream\n");
+        goto cleanup;
+    }
+    if ((error = avcodec_parameters_copy(output_stream->codecpar,
+                                         input_stream->codecpar)) < 0) {
+        fprintf(stderr, "Could not copy stream parameters (error '%s')\n",
+                av_err2str(error));
+        goto cleanup;
+    }
+    /* The tag belongs to the input container. */
+    output_stream->codecpar->codec_tag = 0;
+    output_stream->time_base = input_stream->time_base;
+    if (write_output_file_header(output_format_context))
+        goto cleanup;
+    if (init_packet(&packet))
+        goto cleanup;
+
+    while ((error = av_read_frame(input_format_context, packet)) >= 0) {
+        int64_t packet_end;
+
+        if (packet->stream_index != audio_stream_idx ||
+            packet->pts == AV_NOPTS_VALUE) {
+            av_packet_unref(packet);
+            continue;
+        }
+        /* Skip the packets that end before the start. */
+        packet_end = packet->pts + FFMAX(packet->duration, 1);
+        if (packet_end <= start_pts) {
+            av_packet_unref(packet);
+            continue;
+        }
+        if (packet->pts >= end_pts) {
+            av_packet_unref(packet);
+            break;
+        }
+
+        /* Rebase the timestamps so the clip starts at 0. */
+        if (first_pts == AV_NOPTS_VALUE)
+            first_pts = packet->pts;
+        packet->pts -= first_pts;
+        if (packet->dts != AV_NOPTS_VALUE)
+            packet->dts -= first_pts;
+        packet->stream_index = 0;
+        packet->pos = -1;
+        av_packet_rescale_ts(packet, input_stream->time_base,
+                             output_stream->time_base);
+
+        /* Takes the packet and leaves it blank for the next read. */
+        if ((error = av_interleaved_write_frame(output_format_context,
+                                                packet)) < 0) {
+            fprintf(stderr, "Could not write frame (error '%s')\n",
+                    av_err2str(error));
+            goto cleanup;
+        }
+    }
+    if (error < 0 && error != AVERROR_EOF) {
+        fprintf(stderr, "Could not read frame (error '%s')\n",
+                av_err2str(error));
+        goto cleanup;
+    }
+    if (first_pts == AV_NOPTS_VALUE) {
+        fprintf(stderr, "No audio to copy between %f and %f\n", start, end);
+        goto cleanup;
+    }
+
+    if (write_output_file_trailer(output_format_context))
+        goto cleanup;
+    ret = 0;
+
+cleanup:
+    av_packet_free(&packet);
+    if (output_format_context) {
+        avio_closep(&output_format_context->pb);
+        avformat_free_context(output_format_context);
+    }
+
+    return ret;
+}
+
+/**
+ * Initialize a resampler that turns the decoded samples into signed 16 bit
+ * mono samples at the same sample rate.
+ * @param      input_codec_context Codec context of the input file
+ * @param[out] resample_context    Resample context for the conversion
+ * @return Error code (0 if successful)
+ */
+static int init_pcm_resampler(AVCodecContext *input_codec_context,
+                              SwrContext **resample_context)
+{
+    int error;
+
+    *resample_context = swr_alloc_set_opts(NULL,
+                                          AV_CH_LAYOUT_MONO,
+                                          AV_SAMPLE_FMT_S16,
+                                          input_codec_context->sample_rate,
+                                          av_get_default_channel_layout(input_codec_context->channels),
+                                          input_codec_context->sample_fmt,
+                                          input_codec_context->sample_rate,
+                                          0, NULL);
+    if (!*resample_context) {
+        fprintf(stderr, "Could not allocate resample context\n");
+        return AVERROR(ENOMEM);
+    }
+
+    if ((error = swr_init(*resample_context)) < 0) {
+        fprintf(stderr, "Could not open resample context\n");
+        swr_free(resample_context);
+        return error;
+    }
+    return 0;
+}
+
+/**
+ * Decode the audio of an open input file between start and end to signed
+ * 16 bit mono samples. The samples keep the sample rate of the audio track.
+ * @param session           The open input file.
+ * @param start             Start time of the audio.
+ * @param end               End time of the audio.
+ * @param[out] samples      The decoded samples, free them with av_free.
+ * @param[out] num_samples  The number of samples.
+ * @param[out] sample_rate  The number of samples per second.
+ * @return Error code (0 if successful)
+ */
+int clip_session_decode_pcm(ClipSession *session,
+                            const double start, const double end,
+                            int16_t **samples, int *num_samples, int *sample_rate)
+{
+    int64_t start_pts = 0, end_pts = 0;
+    AVCodecContext *input_codec_context = session->input_codec_context;
+    AVFrame *input_frame = NULL;
+    int capacity = 0;
+    int finished = 0;
+    int ret = AVERROR_EXIT;
+
+    *samples = NULL;
+    *num_samples = 0;
+
+    /* Seek to about the position and set the start and end postion */
+    if (seek_session(session, start, end, &start_pts, &end_pts))
+        goto cleanup;
+    if (!session->pcm_resample_context &&
+        init_pcm_resampler(input_codec_context, &session->pcm_resample_context))
+        goto cleanup;
+    if (init_input_frame(&input_frame))
+        goto cleanup;
+    *sample_rate = input_codec_context->sample_rate;
+
+    while (!finished) {
+        int data_present = 0;
+        int converted;
+        uint8_t *output;
+
+        if (decode_audio_frame(input_frame, session->input_format_context,
+                               input_codec_context, session->audio_stream_idx,
+                               start_pts, end_pts,
+                               &data_present, &finished))
+            goto cleanup;
+        /* Like the transcoder, the frame past the end is left out. */
+        if (finished || !data_present)
+            continue;
+
+        /* Grow the output so it can hold the whole frame. */
+        if (*num_samples + input_frame->nb_samples > capacity) {
+            int16_t *grown;
+            capacity = FFMAX(capacity * 2, *num_samples + input_frame->nb_samples);
+            if (!(grown = av_realloc(*samples, capacity * sizeof(**samples)))) {
+                fprintf(stderr, "Could not allocate decoded samples\n");
+                goto cleanup;
+            }
+            *samples = grown;
+        }
+
+        output = (uint8_t *)(*samples + *num_samples);
+        if ((converted = swr_convert(session->pcm_resample_context,
+                                     &output, input_frame->nb_samples,
+                                     (const uint8_t **)input_frame->extended_data,
+                                     input_frame->nb_samples)) < 0) {
+            fprintf(stderr, "Could not convert input samples (error '%s')\n",
+                    av_err2str(converted));
+            goto cleanup;
+        }
+        *num_samples += converted;
+    }
+    ret = 0;
+
+cleanup:
+    if (ret < 0) {
+        av_freep(samples);
+        *num_samples = 0;
+    }
+    av_frame_free(&input_frame);
 
     return ret;
 }
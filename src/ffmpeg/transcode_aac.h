@@ -21,19 +21,128 @@
 #ifndef TRANSCODE_AAC_H
 #define TRANSCODE_AAC_H
 
+#include <stdint.h>
 #include <stdio.h>
 
+/* An input file kept open between clips, it must only be used by one thread at a time */
+typedef struct ClipSession ClipSession;
+
+/* Codecs clips can be encoded with */
+typedef enum ClipCodec {
+    CLIP_CODEC_AAC,
+    CLIP_CODEC_OPUS,
+    CLIP_CODEC_MP3
+} ClipCodec;
+
+/* Format of the clips that are encoded */
+typedef struct ClipFormat {
+    ClipCodec codec;
+    /* In bit/s */
+    int bit_rate;
+    int channels;
+    /* Samples per second, 0 keeps the rate of the input if the encoder supports it */
+    int sample_rate;
+} ClipFormat;
+
+/* One clip of a batch */
+typedef struct ClipInterval {
+    double start;
+    double end;
+    const char *output_file;
+    /* Error code of the clip (0 if successful), set by the batch */
+    int result;
+} ClipInterval;
+
 /**
- * Clip the audio from an input file to an AAC output file.
+ * Open an input file and its decoder to clip from.
  * @param input_file    The file to read audio streams from.
- * @param output_file   The output file.
  * @param audio_track   Index of the audio stream to clip. Starts from 0.
+ * @return The session, NULL if the file could not be opened
+ */
+ClipSession *clip_session_open(const char *input_file,
+                               const size_t audio_track);
+
+/**
+ * Close the input file and free the session.
+ * @param session   The session to close, may be NULL.
+ */
+void clip_session_close(ClipSession *session);
+
+/**
+ * Find the file extension of the format of a clip.
+ * @param format    The format of the clip.
+ * @return The extension including the dot, NULL if the codec is unknown
+ */
+const char *clip_format_extension(const ClipFormat *format);
+
+/**
+ * Clip the audio of an open input file to an output file.
+ * @param session       The open input file.
+ * @param output_file   The output file, its extension should come from
+ *                      clip_format_extension.
+ * @param format        Format of the output.
+ * @param start         Start time of the clip.
+ * @param end           End time of the clip.
+ * @return Error code (0 if successful)
+ */
+int clip_session_transcode(ClipSession *session, const char *output_file,
+                           const ClipFormat *format,
+                           const double start, const double end);
+
+/**
+ * Decode the audio of an open input file between start and end to signed
+ * 16 bit mono samples. The samples keep the sample rate of the audio track.
+ * @param session           The open input file.
+ * @param start             Start time of the audio.
+ * @param end               End time of the audio.
+ * @param[out] samples      The decoded samples, free them with av_free.
+ * @param[out] num_samples  The number of samples.
+ * @param[out] sample_rate  The number of samples per second.
+ * @return Error code (0 if successful)
+ */
+int clip_session_decode_pcm(ClipSession *session,
+                            const double start, const double end,
+                            int16_t **samples, int *num_samples, int *sample_rate);
+
+/**
+ * Clip several intervals of an open input file to output files while
+ * decoding the covered audio only once, front to back. Every decoded frame
+ * is converted once and then encoded by each clip it belongs to, so
+ * overlapping clips share the decoding.
+ * @param session       The open input file.
+ * @param format        Format of the outputs.
+ * @param clips         The clips sorted by start time. The result of each
+ *                      is set.
+ * @param num_clips     The number of clips.
+ * @return Error code of decoding (0 if successful)
+ */
+int clip_session_transcode_batch(ClipSession *session, const ClipFormat *format,
+                                 ClipInterval *clips, const size_t num_clips);
+
+/**
+ * Check whether the audio track already is in the format of a clip, so it
+ * can be copied instead of transcoded.
+ * @param session   The open input file.
+ * @param format    The format of the clip.
+ * @return The extension including the dot, NULL if the track has to be
+ *         transcoded
+ */
+const char *clip_session_copy_extension(ClipSession *session,
+                                        const ClipFormat *format);
+
+/**
+ * Copy the packets of the audio track between start and end to an output
+ * file without decoding them. The clip begins with the packet the start
+ * falls in, so it can start up to one packet early. The timestamps are
+ * rebased so the clip starts at 0.
+ * @param session       The open input file.
+ * @param output_file   The output file, its extension should come from
+ *                      clip_session_copy_extension.
  * @param start         Start time of the clip.
  * @param end           End time of the clip.
  * @return Error code (0 if successful)
  */
-int transcode_aac(const char *input_file, const char *output_file,
-                  const size_t audio_track,
-                  const double start, const double end);
+int clip_session_remux(ClipSession *session, const char *output_file,
+                       const double start, const double end);
 
 #endif // TRANSCODE_AAC_H
\ No newline at end of file
@@ -24,6 +24,8 @@
 #include "mpvadapter.h"
 #include "../util/constants.h"
 #include "../dict/dictionary.h"
+#include "../ffmpeg/audioclipper.h"
+#include "../util/memoryutils.h"
 
 #include <QCursor>
 #include <QClipboard>
@@ -35,6 +37,7 @@
 #include <QSettings>
 #include <QStyleFactory>
 #include <QInputDialog>
+#include <QJsonDocument>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
@@ -79,6 +82,10 @@ MainWindow::MainWindow(QWidget *parent)
     m_aboutWindow = new AboutWindow;
     m_aboutWindow->hide();
 
+    /* Dictionary Search */
+    m_searchWindow = new SearchWindow;
+    m_searchWindow->hide();
+
     /* Subtitle Search */
     m_subtitle.layoutPlayerOverlay = new QVBoxLayout(m_ui->player);
     m_subtitle.layoutPlayerOverlay->setSpacing(0);
@@ -116,9 +123,12 @@ MainWindow::MainWindow(QWidget *parent)
     /* Toolbar Actions */
     connect(m_ui->actionOptions,     &QAction::triggered, m_optionsWindow, &OptionsWindow::show);
     connect(m_ui->actionAbout,       &QAction::triggered, m_aboutWindow,   &AboutWindow::show);
+    connect(m_ui->actionSearch,      &QAction::triggered, m_searchWindow,  &SearchWindow::show);
     connect(m_ui->actionOpen,        &QAction::triggered, this,            &MainWindow::open);
     connect(m_ui->actionOpenUrl,     &QAction::triggered, this,            &MainWindow::openUrl);
     connect(m_ui->actionUpdate,      &QAction::triggered, this,            &MainWindow::checkForUpdates);
+    connect(m_ui->actionDiagnostics, &QAction::triggered, this,            &MainWindow::showDiagnostics);
+    connect(m_ui->actionMemoryReport, &QAction::triggered, this,           &MainWindow::showMemoryReport);
     connect(m_ui->actionAddSubtitle, &QAction::triggered, this,
         [=] {
             QString file = QFileDialog::getOpenFileName(0, "Open Subtitle");
@@ -241,6 +251,7 @@ MainWindow::~MainWindow()
     delete m_term;
     delete m_optionsWindow;
     delete m_aboutWindow;
+    delete m_searchWindow;
 
     /* Wrappers and Clients */
     delete m_player;
@@ -643,6 +654,32 @@ void MainWindow::openUrl()
     }
 }
 
+void MainWindow::showDiagnostics()
+{
+    QJsonObject diagnostics;
+    diagnostics["dictionary"] = m_mediator->getDictionary()->diagnostics();
+    diagnostics["audioClips"] = m_mediator->getAudioClipper()->diagnostics();
+    QString text = QJsonDocument(diagnostics).toJson();
+    qDebug().noquote() << text;
+    showInfoMessage("Diagnostics", text);
+}
+
+void MainWindow::showMemoryReport()
+{
+    QJsonObject report;
+    report["process"] = QJsonObject{
+        {"residentSet",     MemoryUtils::getResidentSetSize()},
+        {"peakResidentSet", MemoryUtils::getPeakResidentSetSize()}
+    };
+    report["dictionary"]   = m_mediator->getDictionary()->memoryUsage();
+    report["audio"]        = m_mediator->getAudioPlayer()->memoryUsage();
+    report["subtitleList"] = m_ui->subtitleList->memoryUsage();
+    report["subtitle"]     = m_subtitle.subtitleWidget->memoryUsage();
+    QString text = QJsonDocument(report).toJson();
+    qDebug().noquote() << text;
+    showInfoMessage("Memory Report", text);
+}
+
 void MainWindow::checkForUpdates()
 {
     m_manager->setTransferTimeout();
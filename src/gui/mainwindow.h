@@ -24,6 +24,7 @@
 #include <QMainWindow>
 
 #include "widgets/definition/termwidget.h"
+#include "widgets/definition/searchwindow.h"
 #include "widgets/settings/optionswindow.h"
 #include "widgets/aboutwindow.h"
 #include "widgets/subtitlewidget.h"
@@ -97,6 +98,7 @@ private:
     AnkiClient *m_ankiClient;
     OptionsWindow *m_optionsWindow;
     AboutWindow *m_aboutWindow;
+    SearchWindow *m_searchWindow;
 
     struct SubtitleUi
     {
@@ -133,6 +135,8 @@ private:
         QAction *actionDisable
     );
     void checkForUpdates();
+    void showDiagnostics();
+    void showMemoryReport();
 
     inline bool isMouseOverPlayer();
 };
@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2021 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "searchwindow.h"
+
+#include "termwidget.h"
+
+#include "../../../util/globalmediator.h"
+#include "../../../util/constants.h"
+#include "../../../dict/frenchprocessor.h"
+
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QSplitter>
+#include <QVBoxLayout>
+#include <QSettings>
+
+/* Misspelled searches shorter than this are too ambiguous to correct */
+#define FUZZY_MIN_LENGTH    3
+#define FUZZY_MAX_DISTANCE  2
+
+#define DIRECTION_FRENCH    "French → English"
+#define DIRECTION_ENGLISH   "English → French"
+
+SearchWindow::SearchWindow(QWidget *parent) : QDialog(parent)
+{
+    setWindowTitle("Search Dictionary");
+    resize(700, 450);
+
+    QVBoxLayout *parentLayout = new QVBoxLayout(this);
+
+    QHBoxLayout *searchLayout = new QHBoxLayout;
+    m_lineSearch = new QLineEdit;
+    m_lineSearch->setClearButtonEnabled(true);
+    searchLayout->addWidget(m_lineSearch);
+    m_comboDirection = new QComboBox;
+    m_comboDirection->addItem(DIRECTION_FRENCH);
+    m_comboDirection->addItem(DIRECTION_ENGLISH);
+    searchLayout->addWidget(m_comboDirection);
+    parentLayout->addLayout(searchLayout);
+
+    QSplitter *splitter = new QSplitter;
+    m_listResults = new QListWidget;
+    splitter->addWidget(m_listResults);
+    m_term = new TermWidget;
+    m_term->hide();
+    splitter->addWidget(m_term);
+    splitter->setStretchFactor(1, 1);
+    parentLayout->addWidget(splitter);
+    directionChanged();
+
+    connect(m_lineSearch,  &QLineEdit::textChanged,          this, &SearchWindow::updateResults);
+    connect(m_listResults, &QListWidget::currentRowChanged,  this, &SearchWindow::showResult);
+    connect(m_comboDirection, &QComboBox::currentTextChanged, this, &SearchWindow::directionChanged);
+}
+
+SearchWindow::~SearchWindow()
+{
+    disconnect();
+}
+
+void SearchWindow::showEvent(QShowEvent *event)
+{
+    m_lineSearch->setFocus();
+    m_lineSearch->selectAll();
+    QDialog::showEvent(event);
+}
+
+void SearchWindow::directionChanged()
+{
+    if (m_comboDirection->currentText() == DIRECTION_ENGLISH)
+    {
+        m_lineSearch->setPlaceholderText("Type English words to find how to say them in French");
+    }
+    else
+    {
+        m_lineSearch->setPlaceholderText("Type the start of a French word or phrase");
+    }
+    updateResults(m_lineSearch->text());
+}
+
+void SearchWindow::updateResults(const QString &text)
+{
+    m_listResults->clear();
+    m_matches.clear();
+
+    QSettings settings;
+    settings.beginGroup(SETTINGS_SEARCH);
+    int limit = settings.value(SETTINGS_SEARCH_LIMIT, DEFAULT_LIMIT).toInt();
+    settings.endGroup();
+
+    // matches point into this snapshot, so keep it until the next search
+    m_dictionary = GlobalMediator::getGlobalMediator()->getDictionary();
+
+    if (m_comboDirection->currentText() == DIRECTION_ENGLISH)
+    {
+        m_matches = m_dictionary->reverseSearch(text, limit);
+        showMatches();
+        return;
+    }
+
+    QString word = FrenchProcessor::cleanWord(text.trimmed());
+    if (word.isEmpty())
+    {
+        m_term->hide();
+        return;
+    }
+
+    m_matches = m_dictionary->complete(word, limit);
+
+    /* Nothing starts with what was typed, offer the closest spellings instead */
+    if (m_matches.isEmpty() && word.size() >= FUZZY_MIN_LENGTH)
+    {
+        m_matches = m_dictionary->fuzzy(word, FUZZY_MAX_DISTANCE, limit);
+    }
+    showMatches();
+}
+
+void SearchWindow::showMatches()
+{
+    for (const DictionaryMatch &match : m_matches)
+    {
+        m_listResults->addItem(match.distance == 0 ? match.key : match.key + " (?)");
+    }
+
+    if (!m_matches.isEmpty())
+    {
+        m_listResults->setCurrentRow(0);
+    }
+    else
+    {
+        m_term->hide();
+    }
+}
+
+void SearchWindow::showResult(const int row)
+{
+    if (row < 0 || row >= m_matches.size())
+    {
+        return;
+    }
+
+    const DictionaryMatch &match = m_matches[row];
+    SubtitlePhrase phrase{};
+    phrase.start = 0;
+    phrase.stop = match.key.size();
+    phrase.dictEntry = DictEntryHandle{m_dictionary, match.entry};
+    m_term->setTerm(new SubtitleExtract{match.key, phrase});
+    m_term->show();
+}
@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2021 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SEARCHWINDOW_H
+#define SEARCHWINDOW_H
+
+#include <QDialog>
+
+#include "../../../dict/dictionary.h"
+
+class QComboBox;
+class QLineEdit;
+class QListWidget;
+class TermWidget;
+
+class SearchWindow : public QDialog
+{
+    Q_OBJECT
+
+public:
+    SearchWindow(QWidget *parent = nullptr);
+    ~SearchWindow();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private Q_SLOTS:
+    void directionChanged();
+    void updateResults(const QString &text);
+    void showResult(const int row);
+
+private:
+    void showMatches();
+
+    QLineEdit   *m_lineSearch;
+    QComboBox   *m_comboDirection;
+    QListWidget *m_listResults;
+    TermWidget  *m_term;
+
+    std::shared_ptr<Dictionary> m_dictionary;
+    QList<DictionaryMatch> m_matches;
+};
+
+#endif // SEARCHWINDOW_H
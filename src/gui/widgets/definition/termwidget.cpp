@@ -24,13 +24,21 @@
 #include "../../../util/iconfactory.h"
 #include "../../../util/globalmediator.h"
 #include "../../../dict/dictionary.h"
+#include "../../../dict/frenchprocessor.h"
+#include "../../../util/constants.h"
 #include "../../../audio/audioplayer.h"
 
+#include <QDebug>
 #include <QMenu>
+#include <QSettings>
 #include <utility>
 
 #define KANJI_STYLE_STRING      (QString("<style>a { color: %1; border: 0; text-decoration: none; }</style>"))
 #define KANJI_FORMAT_STRING     (QString("<a href=\"%1\">%1</a>"))
+#define SUGGESTION_FORMAT_STRING    (QString("<a href=\"%1\">%2</a>"))
+
+/* Spelling suggestions offered for a word that is not in the dictionary */
+#define SUGGESTION_LIMIT        5
 
 #if __APPLE__
     #define EXPRESSION_STYLE    (QString("QLabel { font-size: 30pt; }"))
@@ -42,6 +50,7 @@
 
 TermWidget::TermWidget(QWidget *parent) : QWidget(parent), m_ui(new Ui::TermWidget), m_term(nullptr) {
     m_ui->setupUi(this);
+    m_ui->suggestionsLabel->setVisible(false);
 
     IconFactory *factory = IconFactory::create();
 
@@ -61,12 +70,12 @@ TermWidget::TermWidget(QWidget *parent) : QWidget(parent), m_ui(new Ui::TermWidg
         [=] {
             if (!sources.isEmpty())
             {
-                const AudioSource &src = sources.first();
-                playAudio(src.lang, src.tld, src.slow);
+                playAudio(sources.first());
             }
         } 
     );
     connect(m_ui->buttonAudio, &QToolButton::customContextMenuRequested, this, &TermWidget::showAudioSources);
+    connect(m_ui->suggestionsLabel, &QLabel::linkActivated, this, &TermWidget::showSuggestion);
 
     auto *ankiClient = GlobalMediator::getGlobalMediator()->getAnkiClient();
     setAddable(ankiClient->isEnabled() && ankiClient->noteAddable(m_term));
@@ -134,11 +143,11 @@ void TermWidget::openAnki()
 //    );
 }
 
-void TermWidget::playAudio(QString lang, QString tld, bool slow)
+void TermWidget::playAudio(const AudioSource &source)
 {
     m_ui->buttonAudio->setEnabled(false);
     QString substring = m_term->subtitleText.mid(m_term->phrase.start, m_term->phrase.stop - m_term->phrase.start);
-    AudioPlayerReply *reply = GlobalMediator::getGlobalMediator()->getAudioPlayer()->playAudio(substring, std::move(lang), std::move(tld), slow);
+    AudioPlayerReply *reply = GlobalMediator::getGlobalMediator()->getAudioPlayer()->playAudio(substring, source);
     m_ui->buttonAudio->setEnabled(reply == nullptr);
 
     if (reply)
@@ -153,6 +162,11 @@ void TermWidget::playAudio(QString lang, QString tld, bool slow)
                 m_ui->buttonAudio->setEnabled(true);
             }
         );
+        connect(reply, &AudioPlayerReply::cancelled, this,
+            [=] {
+                m_ui->buttonAudio->setEnabled(true);
+            }
+        );
     }
 }
 
@@ -161,7 +175,7 @@ void TermWidget::showAudioSources(const QPoint &pos)
     QMenu contextMenu("Audio Sources", m_ui->buttonAudio);
     for (const AudioSource &src : GlobalMediator::getGlobalMediator()->getAudioPlayer()->audioSources)
     {
-        contextMenu.addAction(src.name, this, [=] { playAudio(src.lang, src.tld, src.slow); });
+        contextMenu.addAction(src.name, this, [=] { playAudio(src); });
     }
     contextMenu.exec(m_ui->buttonAudio->mapToGlobal(pos));
 }
@@ -173,21 +187,90 @@ void TermWidget::showAudioSources(const QPoint &pos)
 void TermWidget::setTerm(SubtitleExtract *extract) {
     delete this->m_term;
     this->m_term = extract;
+    this->m_suggestions.clear();
     
     QStringRef phraseStr = m_term->subtitleText.midRef(m_term->phrase.start, m_term->phrase.stop - m_term->phrase.start);
     this->m_ui->extractLabel->setText(phraseStr.toString());
 
-    QString html = "<html><head><style>" + GlobalMediator::getGlobalMediator()->getDictionary()->termCss + "</style><body>";
+    // everything shown for this term comes from the snapshot it was found in
+    if (!m_term->phrase.dictEntry.dictionary) {
+        m_term->phrase.dictEntry.dictionary = GlobalMediator::getGlobalMediator()->getDictionary();
+    }
+
+    if (m_term->phrase.dictEntry != nullptr) {
+        this->m_ui->suggestionsLabel->hide();
+        this->showEntry(m_term->phrase.dictEntry.entry);
+        return;
+    }
+
+    // the word is not in the dictionary, maybe it has a typo
+    QString word = FrenchProcessor::cleanWord(phraseStr.toString());
+    while (!word.isEmpty() && (word[0].isPunct() || word[0].isSpace())) {
+        word.remove(0, 1);
+    }
+    while (!word.isEmpty() && (word[word.size() - 1].isPunct() || word[word.size() - 1].isSpace())) {
+        word.chop(1);
+    }
+
+    QSettings settings;
+    settings.beginGroup(SETTINGS_SEARCH);
+    int maxDistance = settings.value(SETTINGS_SEARCH_SPELLING, DEFAULT_SPELLING).toInt();
+    settings.endGroup();
+
+    if (!word.isEmpty() && maxDistance > 0) {
+        this->m_suggestions = m_term->phrase.dictEntry.dictionary->suggest(word, maxDistance, SUGGESTION_LIMIT);
+    }
+
+    if (this->m_suggestions.isEmpty()) {
+        this->m_ui->suggestionsLabel->setText("No definitions found");
+        this->m_ui->suggestionsLabel->show();
+        this->showEntry(nullptr);
+        return;
+    }
 
-    for (auto &def : m_term->phrase.dictEntry->definitions) {
-        html += def;
+    QStringList links;
+    for (int i = 0; i < this->m_suggestions.size(); i++) {
+        links.append(SUGGESTION_FORMAT_STRING.arg(i).arg(this->m_suggestions[i].key.toHtmlEscaped()));
+    }
+    this->m_ui->suggestionsLabel->setText("Did you mean " + links.join(", "));
+    this->m_ui->suggestionsLabel->show();
+    this->showEntry(this->m_suggestions.first().entry);
+}
+
+void TermWidget::showSuggestion(const QString &link)
+{
+    int index = link.toInt();
+    if (index >= 0 && index < m_suggestions.size())
+    {
+        showEntry(m_suggestions[index].entry);
+    }
+}
+
+void TermWidget::showEntry(DictEntry *entry) {
+    std::shared_ptr<Dictionary> dictionary = m_term->phrase.dictEntry.dictionary;
+    QString html = "<html><head><style>" + dictionary->termCss + "</style><body>";
+
+    if (entry == nullptr) {
+        html += "</body></html>";
+        this->m_ui->webEngineView->setHtml(html);
+        return;
+    }
+
+    // overrides and glossaries come first, then what lower layers say about the same word
+    QList<DictEntry *> entries = dictionary->lookupAll(dictionary->key(entry));
+    if (!entries.contains(entry)) {
+        entries.prepend(entry);
+    }
+    bool unavailable = false;
+    for (DictEntry *layerEntry : entries) {
+        html += dictionary->definitions(layerEntry, &unavailable).join("");
     }
 
     // the extract might not have any definitions because the word isn't a lemma
     // we need to check all forms of the word -> find lemmas -> add their definitions
     std::multimap<QString, SyntaxInfo> lemmas;
 
-    for (SyntaxInfo &info: m_term->phrase.dictEntry->syntaxInfos) {
+    for (SyntaxInfo &info: dictionary->syntaxInfos(entry)) {
         if (!info.lemma.isEmpty()) {
             lemmas.emplace(info.lemma, info);
         }
@@ -197,17 +280,18 @@ void TermWidget::setTerm(SubtitleExtract *extract) {
     auto end = lemmas.end();
     while (it != end) {
         QString lemma = it->first;
-        DictEntry *lemmaEntry = lemma.isEmpty() ? m_term->phrase.dictEntry : GlobalMediator::getGlobalMediator()->getDictionary()->map[lemma];
-
-        if (lemmaEntry != nullptr) {
-            for (auto &def : lemmaEntry->definitions) {
-                html += def;
-            }
+        for (DictEntry *lemmaEntry : dictionary->lookupAll(lemma)) {
+            html += dictionary->definitions(lemmaEntry, &unavailable).join("");
         }
 
         it = lemmas.upper_bound(lemma);
     }
 
+    if (unavailable) {
+        qDebug() << "some definitions of" << dictionary->key(entry) << "could not be read";
+        html += "<p class=\"unavailable\"><i>Definition unavailable, the dictionary file may be damaged.</i></p>";
+    }
+
     html += "</body></html>";
     this->m_ui->webEngineView->setHtml(html);
 }
@@ -26,6 +26,7 @@
 
 #include "../common/flowlayout.h"
 #include "../../../dict/expression.h"
+#include "../../../dict/dictionary.h"
 #include "../../../anki/ankiclient.h"
 
 namespace Ui
@@ -62,12 +63,17 @@ protected:
 private Q_SLOTS:
     void addNote();
     void openAnki();
-    void playAudio(QString lang, QString tld, bool slow);
+    void playAudio(const AudioSource &source);
     void showAudioSources(const QPoint &pos);
+    void showSuggestion(const QString &link);
 
 private:
+    void showEntry(DictEntry *entry);
+
     Ui::TermWidget *m_ui;
     SubtitleExtract *m_term;
+    /* Spelling corrections offered when the extract has no entry */
+    QList<DictionaryMatch> m_suggestions;
 
 };
 
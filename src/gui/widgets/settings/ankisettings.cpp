@@ -36,6 +36,30 @@
 #define SCREENSHOT_JPG              "JPG"
 #define SCREENSHOT_WEBP             "WebP"
 
+#define AUDIO_CODEC_AAC             "AAC"
+#define AUDIO_CODEC_OPUS            "Opus"
+#define AUDIO_CODEC_MP3             "MP3"
+
+#define AUDIO_PRESET_CUSTOM         "Custom"
+
+/* Audio formats offered as presets, the bit rate is in kbps and a sample rate of 0 keeps the one of the media */
+static const struct
+{
+    const char             *name;
+    AnkiConfig::AudioCodec  codec;
+    int                     bitRate;
+    int                     channels;
+    int                     sampleRate;
+} AUDIO_PRESETS[] = {
+    {"AAC 96 kbps Stereo",          AnkiConfig::AudioCodec::aac,  96,  2, 0},
+    {"Opus 32 kbps Mono (Speech)",  AnkiConfig::AudioCodec::opus, 32,  1, 0},
+    {"Opus 64 kbps Stereo",         AnkiConfig::AudioCodec::opus, 64,  2, 0},
+    {"MP3 64 kbps Mono",            AnkiConfig::AudioCodec::mp3,  64,  1, 0},
+    {"MP3 128 kbps Stereo",         AnkiConfig::AudioCodec::mp3,  128, 2, 0},
+};
+
+static const int AUDIO_SAMPLE_RATES[] = {48000, 44100, 32000, 24000, 22050, 16000};
+
 #define REGEX_REMOVE_SPACES_COMMAS "[, ]+"
 
 AnkiSettings::AnkiSettings(QWidget *parent)
@@ -48,9 +72,25 @@ AnkiSettings::AnkiSettings(QWidget *parent)
 
     refreshIcons();
 
+    for (const auto &preset : AUDIO_PRESETS)
+    {
+        m_ui->comboBoxAudioPreset->addItem(preset.name);
+    }
+    m_ui->comboBoxAudioPreset->addItem(AUDIO_PRESET_CUSTOM);
+    m_ui->comboBoxAudioSampleRate->addItem("Same as Media", 0);
+    for (int rate : AUDIO_SAMPLE_RATES)
+    {
+        m_ui->comboBoxAudioSampleRate->addItem(QString("%1 Hz").arg(rate), rate);
+    }
+
     connect(m_ui->checkBoxEnabled,  &QCheckBox::stateChanged,       this, &AnkiSettings::enabledStateChanged);
     connect(m_ui->comboBoxProfile,  &QComboBox::currentTextChanged, this, &AnkiSettings::changeProfile);
     connect(m_ui->buttonConnect,    &QPushButton::clicked,          this, [=] { connectToClient(true); } );
+    connect(m_ui->comboBoxAudioPreset, QOverload<int>::of(&QComboBox::activated), this, &AnkiSettings::applyAudioPreset);
+    connect(m_ui->comboBoxAudioCodec, &QComboBox::currentTextChanged, this, &AnkiSettings::updateAudioPreset);
+    connect(m_ui->spinAudioBitRate, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &AnkiSettings::updateAudioPreset);
+    connect(m_ui->comboBoxAudioChannels, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &AnkiSettings::updateAudioPreset);
+    connect(m_ui->comboBoxAudioSampleRate, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &AnkiSettings::updateAudioPreset);
     connect(m_ui->termCardBuilder,  &CardBuilder::modelTextChanged, this, 
         [=] (const QString &model) {
             updateModelFields(m_ui->termCardBuilder, model);
@@ -328,6 +368,11 @@ void AnkiSettings::restoreDefaults()
 //    defaultConfig.audio.md5       = SETTINGS_AUDIO_SRC_MD5_DEFAULT;
     defaultConfig.audioPadStart   = DEFAULT_AUDIO_PAD_START;
     defaultConfig.audioPadStart   = DEFAULT_AUDIO_PAD_END;
+    defaultConfig.audioExact      = DEFAULT_AUDIO_EXACT;
+    defaultConfig.audioCodec      = DEFAULT_AUDIO_CODEC;
+    defaultConfig.audioBitRate    = DEFAULT_AUDIO_BIT_RATE;
+    defaultConfig.audioChannels   = DEFAULT_AUDIO_CHANNELS;
+    defaultConfig.audioSampleRate = DEFAULT_AUDIO_SAMPLE_RATE;
     defaultConfig.tags.append(DEFAULT_TAGS);
 
     defaultConfig.termDeck        = m_ui->termCardBuilder->getDeckText();
@@ -402,6 +447,19 @@ void AnkiSettings::populateFields(const QString &profile, const AnkiConfig *conf
 
     m_ui->spinAudioPadStart->setValue(config->audioPadStart);
     m_ui->spinAudioPadEnd->setValue(config->audioPadEnd);
+    m_ui->checkBoxAudioExact->setChecked(config->audioExact);
+
+    m_ui->comboBoxAudioCodec->setCurrentText(audioCodecToString(config->audioCodec));
+    m_ui->spinAudioBitRate->setValue(config->audioBitRate / 1000);
+    m_ui->comboBoxAudioChannels->setCurrentIndex(config->audioChannels == 1 ? 0 : 1);
+    int sampleRateIndex = m_ui->comboBoxAudioSampleRate->findData(config->audioSampleRate);
+    if (sampleRateIndex == -1)
+    {
+        m_ui->comboBoxAudioSampleRate->addItem(QString("%1 Hz").arg(config->audioSampleRate), config->audioSampleRate);
+        sampleRateIndex = m_ui->comboBoxAudioSampleRate->count() - 1;
+    }
+    m_ui->comboBoxAudioSampleRate->setCurrentIndex(sampleRateIndex);
+    updateAudioPreset();
 
     QString tags;
     for (auto it = config->tags.begin(); it != config->tags.end(); ++it)
@@ -475,6 +533,73 @@ QString AnkiSettings::fileTypeToString(AnkiConfig::FileType type)
     }
 }
 
+QString AnkiSettings::audioCodecToString(AnkiConfig::AudioCodec codec)
+{
+    switch(codec)
+    {
+    case AnkiConfig::AudioCodec::aac:
+        return AUDIO_CODEC_AAC;
+    case AnkiConfig::AudioCodec::opus:
+        return AUDIO_CODEC_OPUS;
+    case AnkiConfig::AudioCodec::mp3:
+        return AUDIO_CODEC_MP3;
+    default:
+        return AUDIO_CODEC_AAC;
+    }
+}
+
+AnkiConfig::AudioCodec AnkiSettings::stringToAudioCodec(const QString &str)
+{
+    if (str == AUDIO_CODEC_AAC)
+    {
+        return AnkiConfig::AudioCodec::aac;
+    }
+    else if (str == AUDIO_CODEC_OPUS)
+    {
+        return AnkiConfig::AudioCodec::opus;
+    }
+    else if (str == AUDIO_CODEC_MP3)
+    {
+        return AnkiConfig::AudioCodec::mp3;
+    }
+
+    qDebug() << "Invalid audio codec string:" << str;
+    return DEFAULT_AUDIO_CODEC;
+}
+
+void AnkiSettings::updateAudioPreset()
+{
+    const AnkiConfig::AudioCodec codec = stringToAudioCodec(m_ui->comboBoxAudioCodec->currentText());
+    const int bitRate    = m_ui->spinAudioBitRate->value();
+    const int channels   = m_ui->comboBoxAudioChannels->currentIndex() + 1;
+    const int sampleRate = m_ui->comboBoxAudioSampleRate->currentData().toInt();
+
+    for (const auto &preset : AUDIO_PRESETS)
+    {
+        if (preset.codec == codec && preset.bitRate == bitRate &&
+            preset.channels == channels && preset.sampleRate == sampleRate)
+        {
+            m_ui->comboBoxAudioPreset->setCurrentText(preset.name);
+            return;
+        }
+    }
+    m_ui->comboBoxAudioPreset->setCurrentText(AUDIO_PRESET_CUSTOM);
+}
+
+void AnkiSettings::applyAudioPreset(int index)
+{
+    if (index < 0 || index >= (int)(sizeof(AUDIO_PRESETS) / sizeof(AUDIO_PRESETS[0])))
+    {
+        return;
+    }
+    m_ui->comboBoxAudioCodec->setCurrentText(audioCodecToString(AUDIO_PRESETS[index].codec));
+    m_ui->spinAudioBitRate->setValue(AUDIO_PRESETS[index].bitRate);
+    m_ui->comboBoxAudioChannels->setCurrentIndex(AUDIO_PRESETS[index].channels - 1);
+    m_ui->comboBoxAudioSampleRate->setCurrentIndex(
+        m_ui->comboBoxAudioSampleRate->findData(AUDIO_PRESETS[index].sampleRate)
+    );
+}
+
 AnkiConfig::FileType AnkiSettings::stringToFileType(const QString &str)
 {
     if (str == SCREENSHOT_JPG)
@@ -512,6 +637,12 @@ void AnkiSettings::applyToConfig(const QString &profile)
 
     config->audioPadStart = m_ui->spinAudioPadStart->value();
     config->audioPadEnd   = m_ui->spinAudioPadEnd->value();
+    config->audioExact    = m_ui->checkBoxAudioExact->isChecked();
+
+    config->audioCodec      = stringToAudioCodec(m_ui->comboBoxAudioCodec->currentText());
+    config->audioBitRate    = m_ui->spinAudioBitRate->value() * 1000;
+    config->audioChannels   = m_ui->comboBoxAudioChannels->currentIndex() + 1;
+    config->audioSampleRate = m_ui->comboBoxAudioSampleRate->currentData().toInt();
 
     config->tags = QJsonArray();
     QStringList splitTags =
@@ -79,6 +79,16 @@ private:
 
     AnkiConfig::FileType stringToFileType(const QString &str);
 
+    QString audioCodecToString(AnkiConfig::AudioCodec codec);
+
+    AnkiConfig::AudioCodec stringToAudioCodec(const QString &str);
+
+    /* Selects the preset the audio format fields match, Custom if there is none */
+    void updateAudioPreset();
+
+    /* Fills the audio format fields from the selected preset */
+    void applyAudioPreset(int index);
+
     void applyToConfig(const QString &profile);
 
     void renameProfile(const QString &oldName, const QString &newName);
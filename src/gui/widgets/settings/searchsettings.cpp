@@ -71,6 +71,7 @@ void SearchSettings::resetSaved()
     m_ui->checkReplaceNewLines->setChecked    (settings.value(SETTINGS_SEARCH_REPLACE_LINES, DEFAULT_REPLACE_LINES).toBool());
     m_ui->lineEditReplace     ->setText       (settings.value(SETTINGS_SERACH_REPLACE_WITH,  DEFAULT_REPLACE_WITH).toString());
     m_ui->lineRemoveRegex     ->setText       (settings.value(SETTINGS_SEARCH_REMOVE_REGEX,  DEFAULT_REMOVE_REGEX).toString());
+    m_ui->spinSpelling        ->setValue      (settings.value(SETTINGS_SEARCH_SPELLING,      DEFAULT_SPELLING).toInt());
     settings.endGroup();
 }
 
@@ -85,6 +86,7 @@ void SearchSettings::resetDefault()
     m_ui->checkReplaceNewLines->setChecked    (DEFAULT_REPLACE_LINES);
     m_ui->lineEditReplace     ->setText       (DEFAULT_REPLACE_WITH);
     m_ui->lineRemoveRegex     ->setText       (DEFAULT_REMOVE_REGEX);
+    m_ui->spinSpelling        ->setValue      (DEFAULT_SPELLING);
 }
 
 void SearchSettings::applySettings()
@@ -100,6 +102,7 @@ void SearchSettings::applySettings()
     settings.setValue(SETTINGS_SEARCH_REPLACE_LINES, m_ui->checkReplaceNewLines->isChecked());
     settings.setValue(SETTINGS_SERACH_REPLACE_WITH,  m_ui->lineEditReplace->text());
     settings.setValue(SETTINGS_SEARCH_REMOVE_REGEX,  m_ui->lineRemoveRegex->text());
+    settings.setValue(SETTINGS_SEARCH_SPELLING,      m_ui->spinSpelling->value());
     settings.endGroup();
 
     Q_EMIT GlobalMediator::getGlobalMediator()->searchSettingsChanged();
@@ -24,12 +24,21 @@
 #include "../../util/directoryutils.h"
 #include "../../util/globalmediator.h"
 #include "../../util/constants.h"
+#include "../../util/memoryutils.h"
 #include "../playeradapter.h"
+#include "../../anki/ankiclient.h"
+#include "../../ffmpeg/audioclipper.h"
 
 #include <iterator>
 #include <QMultiMap>
 #include <QApplication>
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMenu>
+#include <QMessageBox>
 #include <QSettings>
+#include <QThreadPool>
 
 SubtitleListWidget::SubtitleListWidget(QWidget *parent)
     : QWidget(parent),
@@ -43,6 +52,8 @@ SubtitleListWidget::SubtitleListWidget(QWidget *parent)
 
     /* Signals */
     connect(m_ui->tablePrim, &QTableWidget::itemDoubleClicked, this, &SubtitleListWidget::seekToPrimarySubtitle);
+    m_ui->tablePrim->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(m_ui->tablePrim, &QWidget::customContextMenuRequested, this, &SubtitleListWidget::showPrimaryContextMenu);
     connect(m_ui->tableSec,  &QTableWidget::itemDoubleClicked, this, &SubtitleListWidget::seekToSecondarySubtitle);
 
     connect(m_ui->tabWidget, &QTabWidget::currentChanged, this, &SubtitleListWidget::fixTableDimensions);
@@ -141,6 +152,57 @@ QString SubtitleListWidget::getSecondaryContext(const QString &seperator) const
     return getContext(m_ui->tableSec, seperator);
 }
 
+QJsonObject SubtitleListWidget::memoryUsage() const
+{
+    QJsonObject primary = tableMemoryUsage(m_ui->tablePrim, m_seenPrimarySubs, m_timesPrimarySubs);
+    QJsonObject secondary = tableMemoryUsage(m_ui->tableSec, m_seenSecondarySubs, m_timesSecondarySubs);
+
+    qint64 secondaryIndex = 0;
+    for (auto it = m_subSecondaryToTime.constBegin(); it != m_subSecondaryToTime.constEnd(); ++it)
+    {
+        secondaryIndex += sizeof(QHashNode<QString, double>) + MemoryUtils::heapSize(it.key());
+    }
+    secondary["heap"] = (qint64) secondary["heap"].toDouble() + secondaryIndex;
+    primary["heap"] = (qint64) primary["heap"].toDouble() +
+                      m_endTimesPrimarySubs.size() * (qint64) sizeof(QHashNode<QTableWidgetItem *, double>);
+
+    return QJsonObject{
+        {"primary", primary},
+        {"secondary", secondary},
+        {"heap", (qint64) (primary["heap"].toDouble() + secondary["heap"].toDouble())}
+    };
+}
+
+QJsonObject SubtitleListWidget::tableMemoryUsage(const QTableWidget                      *table,
+                                                 const QMap<double, QTableWidgetItem *>  &seenSubs,
+                                                 const QHash<QTableWidgetItem *, double> &startTimes) const
+{
+    qint64 text = 0;
+    qint64 items = 0;
+    for (int row = 0; row < table->rowCount(); ++row)
+    {
+        for (int column = 0; column < table->columnCount(); ++column)
+        {
+            const QTableWidgetItem *item = table->item(row, column);
+            if (item)
+            {
+                /* Each item keeps its text in a QVariant in a vector of role data */
+                ++items;
+                text += MemoryUtils::heapSize(item->text());
+            }
+        }
+    }
+    qint64 overhead = items * (sizeof(QTableWidgetItem) + sizeof(QArrayData) + 2 * sizeof(QVariant)) +
+                      seenSubs.size() * sizeof(QMapNode<double, QTableWidgetItem *>) +
+                      startTimes.size() * sizeof(QHashNode<QTableWidgetItem *, double>);
+    return QJsonObject{
+        {"rows", table->rowCount()},
+        {"text", text},
+        {"overhead", overhead},
+        {"heap", text + overhead}
+    };
+}
+
 QString SubtitleListWidget::formatTimecode(const int time)
 {
     const int SECONDS_IN_HOUR = 3600;
@@ -196,6 +258,7 @@ void SubtitleListWidget::addPrimarySubtitle(const QString &subtitle,
                                             const double   delay)
 {
     addSubtitle(m_ui->tablePrim, m_seenPrimarySubs, m_timesPrimarySubs, subtitle, start, delay);
+    m_endTimesPrimarySubs.insert(m_seenPrimarySubs.value(start), end);
 }
 
 #define TIME_DELTA 5
@@ -279,6 +342,7 @@ void SubtitleListWidget::clearSubtitles(QTableWidget                      *table
 
 void SubtitleListWidget::clearPrimarySubtitles()
 {
+    m_endTimesPrimarySubs.clear();
     clearSubtitles(m_ui->tablePrim, m_seenPrimarySubs, m_timesPrimarySubs);
 }
 
@@ -310,6 +374,82 @@ void SubtitleListWidget::seekToSecondarySubtitle(QTableWidgetItem *item) const
     seekToSubtitle(item, m_timesSecondarySubs);
 }
 
+void SubtitleListWidget::showPrimaryContextMenu(const QPoint &pos)
+{
+    QMenu contextMenu(m_ui->tablePrim);
+    QAction *exportAction = contextMenu.addAction("Export Audio of Selection...", this, &SubtitleListWidget::exportSelectedAudio);
+    exportAction->setEnabled(!m_ui->tablePrim->selectedItems().isEmpty());
+    contextMenu.exec(m_ui->tablePrim->viewport()->mapToGlobal(pos));
+}
+
+void SubtitleListWidget::exportSelectedAudio()
+{
+    GlobalMediator   *mediator = GlobalMediator::getGlobalMediator();
+    PlayerAdapter    *player   = mediator->getPlayerAdapter();
+    const AnkiConfig *config   = mediator->getAnkiClient()->getConfig();
+    if (config == nullptr || player->getPath().isEmpty())
+    {
+        return;
+    }
+
+    QString dir = QFileDialog::getExistingDirectory(this, "Export Audio");
+    if (dir.isEmpty())
+    {
+        return;
+    }
+
+    /* Padded and shifted by the delays like the audio media of a card */
+    const ClipFormat format    = AnkiClient::audioFormat(config);
+    const QString    extension = clip_format_extension(&format);
+    const QString    baseName  = QFileInfo(player->getPath()).completeBaseName();
+    const double     offset    = player->getSubDelay() - player->getAudioDelay();
+    QList<AudioClipper::Clip> clips;
+    for (QTableWidgetItem *item : m_ui->tablePrim->selectedItems())
+    {
+        if (!m_endTimesPrimarySubs.contains(item))
+        {
+            continue;
+        }
+        AudioClipper::Clip clip;
+        clip.start = qMax(0.0, m_timesPrimarySubs[item] + offset - config->audioPadStart);
+        clip.end   = m_endTimesPrimarySubs[item] + offset + config->audioPadEnd;
+        clip.outputFile = QDir(dir).filePath(
+            QString("%1_%2%3").arg(baseName).arg(item->row() + 1, 4, 10, QLatin1Char('0')).arg(extension)
+        );
+        if (clip.start < clip.end)
+        {
+            clips.append(clip);
+        }
+    }
+    if (clips.isEmpty())
+    {
+        return;
+    }
+
+    const QString inputFile = player->getPath();
+    const size_t  track     = player->getAudioTrack() - 1;
+    QThreadPool::globalInstance()->start(
+        [=] {
+            QList<AudioClipper::Clip> results = clips;
+            GlobalMediator::getGlobalMediator()->getAudioClipper()->transcode(inputFile, track, format, results);
+            int made = 0;
+            for (const AudioClipper::Clip &clip : results)
+            {
+                made += clip.success ? 1 : 0;
+            }
+
+            /* The widget may be gone by the time the clips are done */
+            QMetaObject::invokeMethod(QCoreApplication::instance(),
+                [=] {
+                    QMessageBox::information(nullptr, "Export Audio",
+                        QString("Exported %1 of %2 clips to %3").arg(made).arg(results.size()).arg(dir));
+                },
+                Qt::QueuedConnection
+            );
+        }
+    );
+}
+
 void SubtitleListWidget::showEvent(QShowEvent *event)
 {
     QWidget::showEvent(event);
@@ -24,6 +24,7 @@
 #include <QWidget>
 
 #include <QHash>
+#include <QJsonObject>
 #include <QMultiHash>
 #include <QMap>
 
@@ -46,6 +47,9 @@ public:
     QString getPrimaryContext  (const QString &seperator) const;
     QString getSecondaryContext(const QString &seperator) const;
 
+    /* Rows and estimated heap bytes of both subtitle tables */
+    QJsonObject memoryUsage() const;
+
 protected:
     void showEvent  (QShowEvent *event)   override;
     void hideEvent  (QHideEvent *event)   override;
@@ -71,11 +75,16 @@ private Q_SLOTS:
     void seekToPrimarySubtitle  (QTableWidgetItem *item) const;
     void seekToSecondarySubtitle(QTableWidgetItem *item) const;
 
+    void showPrimaryContextMenu(const QPoint &pos);
+    /* Clips the audio of each selected primary subtitle into a directory, in one decoding pass */
+    void exportSelectedAudio();
+
 private:
     Ui::SubtitleListWidget *m_ui;
 
     QMap<double, QTableWidgetItem *>  m_seenPrimarySubs;
     QHash<QTableWidgetItem *, double> m_timesPrimarySubs;
+    QHash<QTableWidgetItem *, double> m_endTimesPrimarySubs;
 
     QMap<double, QTableWidgetItem *>  m_seenSecondarySubs;
     QHash<QTableWidgetItem *, double> m_timesSecondarySubs;
@@ -86,6 +95,10 @@ private:
 
     QString formatTimecode(const int time);
 
+    QJsonObject tableMemoryUsage(const QTableWidget                      *table,
+                                 const QMap<double, QTableWidgetItem *>  &seenSubs,
+                                 const QHash<QTableWidgetItem *, double> &startTimes) const;
+
     QString getContext(const QTableWidget *table, 
                        const QString      &seperator) const;
     
@@ -23,10 +23,12 @@
 #include "../../util/directoryutils.h"
 #include "../../util/globalmediator.h"
 #include "../../util/constants.h"
+#include "../../util/memoryutils.h"
 
 #include "../playeradapter.h"
 
 #include "../../dict/frenchprocessor.h"
+#include "../../audio/audioplayer.h"
 
 #include <QApplication>
 #include <QClipboard>
@@ -65,6 +67,21 @@ SubtitleWidget::SubtitleWidget(QWidget *parent) : QWidget(parent),
         [=] (const bool paused) {
             m_paused = paused;
             adjustVisibility();
+            if (paused)
+            {
+                prefetchAudio();
+            }
+            else
+            {
+                mediator->getAudioPlayer()->cancelPrefetch();
+            }
+        }
+    );
+    /* Recolor the current subtitle with the reloaded dictionary */
+    connect(mediator,    &GlobalMediator::dictionaryChanged,          this,
+        [=] {
+            subtitleInfo = mediator->getFrenchProcessor()->processSubtitle(m_rawText);
+            update();
         }
     );
 }
@@ -74,6 +91,22 @@ SubtitleWidget::~SubtitleWidget()
     disconnect();
 }
 
+QJsonObject SubtitleWidget::memoryUsage() const
+{
+    /* Phrases only point into the dictionary snapshot, entries are counted with the dictionary */
+    qint64 processed = subtitleInfo.charColors.capacity() * sizeof(SubtitleCharColors) +
+                       subtitleInfo.phrases.capacity() * sizeof(SubtitlePhrase);
+    qint64 layout = textLayouts.size() * sizeof(QTextLayout) +
+                    charBoundaries.capacity() * sizeof(QRectF);
+    return QJsonObject{
+        {"text", MemoryUtils::heapSize(m_rawText)},
+        {"processedSubtitle", processed},
+        {"phrases", (qint64) subtitleInfo.phrases.size()},
+        {"layout", layout},
+        {"heap", MemoryUtils::heapSize(m_rawText) + processed + layout}
+    };
+}
+
 void SubtitleWidget::adjustVisibility()
 {
     if (m_rawText.isEmpty())
@@ -107,6 +140,38 @@ void SubtitleWidget::setSubtitle(QString subtitle,
     m_endTime = end + delay;
 
     adjustVisibility();
+    if (m_paused)
+    {
+        prefetchAudio();
+    }
+}
+
+void SubtitleWidget::prefetchAudio()
+{
+    AudioPlayer *player = GlobalMediator::getGlobalMediator()->getAudioPlayer();
+    if (player->audioSources.isEmpty())
+    {
+        return;
+    }
+
+    /* The phrase that was clicked is the one most likely to be played, then the rest of the line in order */
+    QStringList texts;
+    bool foundCurrent = false;
+    for (const SubtitlePhrase &phrase : subtitleInfo.phrases)
+    {
+        QString text = m_rawText.mid(phrase.start, phrase.stop - phrase.start);
+        if (!foundCurrent && m_currentIndex >= phrase.start && m_currentIndex < phrase.stop)
+        {
+            texts.prepend(text);
+            foundCurrent = true;
+        }
+        else
+        {
+            texts.append(text);
+        }
+    }
+    texts.removeDuplicates();
+    player->prefetchAudio(texts, player->audioSources.first());
 }
 
 void SubtitleWidget::positionChanged(const double value)
@@ -115,6 +180,7 @@ void SubtitleWidget::positionChanged(const double value)
     {
         m_rawText = "";
         hide();
+        GlobalMediator::getGlobalMediator()->getAudioPlayer()->cancelPrefetch();
         Q_EMIT GlobalMediator::getGlobalMediator()->subtitleExpired();
     }
 }
@@ -137,6 +203,7 @@ void SubtitleWidget::mousePressEvent(QMouseEvent *event)
                     }
 
                     m_currentIndex = i;
+                    prefetchAudio();
                 }
                 break;
             }
@@ -23,6 +23,7 @@
 
 #include "../../dict/expression.h"
 
+#include <QJsonObject>
 #include <QWidget>
 #include <QMouseEvent>
 #include <QTimer>
@@ -38,6 +39,9 @@ public:
     SubtitleWidget(QWidget *parent = 0);
     ~SubtitleWidget();
 
+    /* Heap bytes of the processed subtitle being shown and its layout */
+    QJsonObject memoryUsage() const;
+
 protected:
     void mousePressEvent(QMouseEvent *event) override;
     void mouseDoubleClickEvent(QMouseEvent *event) override;
@@ -70,6 +74,7 @@ private:
     void changeFont();
     void loadTextLayout();
     void fitToContents();
+    void prefetchAudio();
 };
 
 #endif // SUBTITLEWIDGET_H
\ No newline at end of file
@@ -23,17 +23,23 @@
 #include <QFile>
 #include <QMessageBox>
 #include <QFontDatabase>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QSettings>
+#include <QThreadPool>
 
 #include "gui/mainwindow.h"
 #include "util/constants.h"
 #include "util/directoryutils.h"
 #include "util/globalmediator.h"
 #include "util/iconfactory.h"
+#include "util/memoryutils.h"
 #include "audio/audioplayer.h"
+#include "ffmpeg/audioclipper.h"
 
 #include "dict/dictionary.h"
 #include "dict/frenchprocessor.h"
+#include "dict/dictionarywatcher.h"
 
 #if __APPLE__
     #include <locale.h>
@@ -115,9 +121,11 @@ int main(int argc, char *argv[])
     setlocale(LC_NUMERIC, "C");
     
     GlobalMediator::createGlobalMedaitor();
+    GlobalMediator::getGlobalMediator()->setAudioClipper(new AudioClipper);
     GlobalMediator::getGlobalMediator()->setAudioPlayer(new AudioPlayer);
+    Dictionary::removeStaleCopies();
     try {
-        GlobalMediator::getGlobalMediator()->setDictionary(new Dictionary);
+        GlobalMediator::getGlobalMediator()->setDictionary(std::make_shared<Dictionary>());
     } catch (std::exception &e) {
         QMessageBox::critical(0, "Error reading dictionary",
                               QString("Error reading dictionary:\n") + e.what());
@@ -125,15 +133,44 @@ int main(int argc, char *argv[])
     }
     GlobalMediator::getGlobalMediator()->setFrenchProcessor(new FrenchProcessor);
 
+    /* Print what loading took in memory and quit, for comparing builds without a window */
+    if (memento.arguments().contains("--memory-report"))
+    {
+        QJsonObject report{
+            {"process", QJsonObject{
+                {"residentSet",     MemoryUtils::getResidentSetSize()},
+                {"peakResidentSet", MemoryUtils::getPeakResidentSetSize()}
+            }},
+            {"dictionary", GlobalMediator::getGlobalMediator()->getDictionary()->memoryUsage()},
+            {"audio",      GlobalMediator::getGlobalMediator()->getAudioPlayer()->memoryUsage()}
+        };
+        QFile out;
+        out.open(stdout, QFile::WriteOnly);
+        out.write(QJsonDocument(report).toJson());
+        out.close();
+
+        delete GlobalMediator::getGlobalMediator()->getFrenchProcessor();
+        GlobalMediator::getGlobalMediator()->setDictionary(nullptr);
+        delete GlobalMediator::getGlobalMediator()->getAudioPlayer();
+        delete GlobalMediator::getGlobalMediator()->getAudioClipper();
+        delete GlobalMediator::getGlobalMediator();
+        return EXIT_SUCCESS;
+    }
+
+    DictionaryWatcher *dictionaryWatcher = new DictionaryWatcher;
+
     MainWindow *main_window = new MainWindow;
     main_window->show();
     int ret = memento.exec();
 
     /* Deallocate shared resources */
     delete main_window;
+    QThreadPool::globalInstance()->waitForDone();
+    delete dictionaryWatcher;
     delete GlobalMediator::getGlobalMediator()->getFrenchProcessor();
-    delete GlobalMediator::getGlobalMediator()->getDictionary();
+    GlobalMediator::getGlobalMediator()->setDictionary(nullptr);
     delete GlobalMediator::getGlobalMediator()->getAudioPlayer();
+    delete GlobalMediator::getGlobalMediator()->getAudioClipper();
     delete GlobalMediator::getGlobalMediator();
     delete IconFactory::create();
 
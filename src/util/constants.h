@@ -45,6 +45,7 @@
 #define SETTINGS_SEARCH_REPLACE_LINES   "replace-lines"
 #define SETTINGS_SERACH_REPLACE_WITH    "replace-with"
 #define SETTINGS_SEARCH_REMOVE_REGEX    "remove-regex"
+#define SETTINGS_SEARCH_SPELLING        "spelling-distance"
 
 #define MODIFIER_ALT                    "Alt"
 #define MODIFIER_CTRL                   "Control"
@@ -63,6 +64,19 @@
 #define DEFAULT_REPLACE_LINES           false
 #define DEFAULT_REPLACE_WITH            ""
 #define DEFAULT_REMOVE_REGEX            ""
+#define DEFAULT_SPELLING                2
+
+/* Audio Settings */
+#define SETTINGS_AUDIO                  "audio"
+#define SETTINGS_AUDIO_CACHE_SIZE       "tts-cache-size"
+#define SETTINGS_AUDIO_MEMORY_SIZE      "tts-memory-size"
+#define SETTINGS_AUDIO_ORIGINAL_NARROW  "original-narrow"
+
+/* A cache size of 0 keeps speech off the disk, only in memory */
+#define DEFAULT_AUDIO_CACHE_SIZE        (64 * 1024 * 1024)
+#define DEFAULT_AUDIO_MEMORY_SIZE       (16 * 1024 * 1024)
+/* Original audio of a phrase is cut from its line by where the phrase is in the text */
+#define DEFAULT_AUDIO_ORIGINAL_NARROW   true
 
 /* Interface Settings */
 enum class Theme
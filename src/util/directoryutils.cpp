@@ -70,7 +70,22 @@ QString DirectoryUtils::getDictionaryCssFile()
     return getConfigDir() + DICT_FILE + ".css";
 }
 
+QString DirectoryUtils::getDictionaryLayersDir()
+{
+    return getConfigDir() + DICT_LAYERS_DIR + SLASH;
+}
+
 QString DirectoryUtils::getMpvInputConfig()
 {
     return getConfigDir() + MPV_INPUT_CONF_FILE;
-}
\ No newline at end of file
+}
+
+QString DirectoryUtils::getTtsCacheDir()
+{
+    return getConfigDir() + TTS_CACHE_DIR + SLASH;
+}
+
+QString DirectoryUtils::getDictionaryCopyDir()
+{
+    return getConfigDir() + DICT_COPY_DIR + SLASH;
+}
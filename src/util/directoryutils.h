@@ -34,7 +34,10 @@
 #endif
 
 #define DICT_FILE        "fren.dict"
+#define DICT_LAYERS_DIR  "dictionaries"
 #define MPV_INPUT_CONF_FILE "input.conf"
+#define TTS_CACHE_DIR    "tts"
+#define DICT_COPY_DIR    "dictcopies"
 
 class DirectoryUtils
 {
@@ -44,7 +47,10 @@ public:
     static QString getGlobalConfigDir();
     static QString getDictionaryFile();
     static QString getDictionaryCssFile();
+    static QString getDictionaryLayersDir();
     static QString getMpvInputConfig();
+    static QString getTtsCacheDir();
+    static QString getDictionaryCopyDir();
     
 private:
     DirectoryUtils() {}
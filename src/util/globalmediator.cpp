@@ -24,12 +24,12 @@
 
 GlobalMediator::GlobalMediator(QObject *parent) : QObject(parent)
 {
-    m_dictionary   = nullptr;
     m_ankiClient   = nullptr;
     m_player       = nullptr;
     m_playerWidget = nullptr;
     m_subList      = nullptr;
     m_audioPlayer  = nullptr;
+    m_audioClipper = nullptr;
     m_frenchProcessor = nullptr;
 }
 
@@ -44,9 +44,9 @@ GlobalMediator *GlobalMediator::getGlobalMediator()
     return m_mediator;
 }
 
-Dictionary *GlobalMediator::getDictionary() const
+std::shared_ptr<Dictionary> GlobalMediator::getDictionary() const
 {
-    return m_dictionary;
+    return std::atomic_load(&m_dictionary);
 }
 
 PlayerAdapter *GlobalMediator::getPlayerAdapter() const
@@ -74,13 +74,19 @@ AudioPlayer *GlobalMediator::getAudioPlayer() const
     return m_audioPlayer;
 }
 
+AudioClipper *GlobalMediator::getAudioClipper() const
+{
+    return m_audioClipper;
+}
+
 FrenchProcessor *GlobalMediator::getFrenchProcessor() const {
     return m_frenchProcessor;
 }
 
-GlobalMediator *GlobalMediator::setDictionary(Dictionary *dictionary)
+GlobalMediator *GlobalMediator::setDictionary(std::shared_ptr<Dictionary> dictionary)
 {
-    m_dictionary = dictionary;
+    std::atomic_store(&m_dictionary, dictionary);
+    Q_EMIT dictionaryChanged();
     return m_mediator;
 }
 
@@ -114,6 +120,12 @@ GlobalMediator *GlobalMediator::setAudioPlayer(AudioPlayer *audioPlayer)
     return m_mediator;
 }
 
+GlobalMediator *GlobalMediator::setAudioClipper(AudioClipper *audioClipper)
+{
+    m_audioClipper = audioClipper;
+    return m_mediator;
+}
+
 GlobalMediator *GlobalMediator::setFrenchProcessor(FrenchProcessor *frenchProcessor) {
     m_frenchProcessor = frenchProcessor;
     return m_mediator;
@@ -22,12 +22,14 @@
 #define GLOBALMEDIATOR_H
 
 #include <QObject>
+#include <memory>
 
 class Dictionary;
 class PlayerAdapter;
 class AnkiClient;
 class SubtitleListWidget;
 class AudioPlayer;
+class AudioClipper;
 class FrenchProcessor;
 class QWidget;
 
@@ -48,21 +50,26 @@ public:
     static GlobalMediator *createGlobalMedaitor();
     static GlobalMediator *getGlobalMediator();
 
-    Dictionary         *getDictionary()         const;
+    /* Current dictionary snapshot, keep the pointer for as long as its entries are used */
+    std::shared_ptr<Dictionary> getDictionary() const;
     PlayerAdapter      *getPlayerAdapter()      const;
     QWidget            *getPlayerWidget()       const;
     AnkiClient         *getAnkiClient()         const;
     SubtitleListWidget *getSubtitleListWidget() const;
     AudioPlayer        *getAudioPlayer()        const;
+    AudioClipper       *getAudioClipper()       const;
     FrenchProcessor    *getFrenchProcessor()    const;
 
+    /* Publishes a new dictionary snapshot, the old one is freed once nothing uses it */
+    GlobalMediator *setDictionary   (std::shared_ptr<Dictionary> dictionary);
+
     /* Mediator does not take ownership */
-    GlobalMediator *setDictionary   (Dictionary         *dictionary);
     GlobalMediator *setPlayerAdapter(PlayerAdapter      *player);
     GlobalMediator *setPlayerWidget (QWidget            *widget);
     GlobalMediator *setAnkiClient   (AnkiClient         *client);
     GlobalMediator *setSubtitleList (SubtitleListWidget *subList);
     GlobalMediator *setAudioPlayer  (AudioPlayer        *audioPlayer);
+    GlobalMediator *setAudioClipper (AudioClipper       *audioClipper);
     GlobalMediator *setFrenchProcessor (FrenchProcessor *frenchProcessor);
 
 Q_SIGNALS:
@@ -144,6 +151,7 @@ Q_SIGNALS:
 
     /* Dictionary Signals */
     void dictionaryAdded() const;
+    void dictionaryChanged() const;
 
     /* Subtitle List Widget */
     void subtitleListHidden();
@@ -157,13 +165,16 @@ Q_SIGNALS:
 private:
     inline static GlobalMediator *m_mediator = nullptr;
 
+    /* Only accessed atomically, snapshots are swapped in from the reload thread */
+    std::shared_ptr<Dictionary> m_dictionary;
+
     /* Mediator does not take ownership */
-    Dictionary         *m_dictionary;
     AnkiClient         *m_ankiClient;
     PlayerAdapter      *m_player;
     QWidget            *m_playerWidget;
     SubtitleListWidget *m_subList;
     AudioPlayer        *m_audioPlayer;
+    AudioClipper       *m_audioClipper;
     FrenchProcessor    *m_frenchProcessor;
 
     GlobalMediator(QObject *parent = nullptr);
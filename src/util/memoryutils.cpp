@@ -0,0 +1,94 @@
+//
+// Created by user on 10/19/26.
+//
+
+#include "memoryutils.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+    #include <windows.h>
+    #include <psapi.h>
+#elif __APPLE__
+    #include <mach/mach.h>
+    #include <sys/resource.h>
+#elif __linux__
+    #include <QFile>
+    #include <sys/resource.h>
+    #include <unistd.h>
+#endif
+
+qint64 MemoryUtils::getResidentSetSize()
+{
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return 0;
+    }
+    return counters.WorkingSetSize;
+#elif __APPLE__
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS)
+    {
+        return 0;
+    }
+    return info.resident_size;
+#elif __linux__
+    /* Second field is the resident set in pages */
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QFile::ReadOnly))
+    {
+        return 0;
+    }
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2)
+    {
+        return 0;
+    }
+    return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+qint64 MemoryUtils::getPeakResidentSetSize()
+{
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+    #ifdef __APPLE__
+        return usage.ru_maxrss;
+    #else
+        /* Kilobytes everywhere but macOS */
+        return (qint64) usage.ru_maxrss * 1024;
+    #endif
+#endif
+}
+
+qint64 MemoryUtils::heapSize(const QString &string)
+{
+    if (string.capacity() == 0)
+    {
+        return 0;
+    }
+    return sizeof(QArrayData) + ((qint64) string.capacity() + 1) * sizeof(QChar);
+}
+
+qint64 MemoryUtils::heapSize(const QByteArray &bytes)
+{
+    if (bytes.capacity() == 0)
+    {
+        return 0;
+    }
+    return sizeof(QArrayData) + (qint64) bytes.capacity() + 1;
+}
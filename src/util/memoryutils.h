@@ -0,0 +1,57 @@
+//
+// Created by user on 10/19/26.
+//
+
+#ifndef MEMORYUTILS_H
+#define MEMORYUTILS_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+/**
+ * Sizes for the memory report. Container sizes are estimates of what Qt allocates on the heap,
+ * implicitly shared data is counted in full by every container that shares it.
+ */
+class MemoryUtils
+{
+public:
+    /* Resident set of the process in bytes, 0 where the platform does not say */
+    static qint64 getResidentSetSize();
+    static qint64 getPeakResidentSetSize();
+
+    static qint64 heapSize(const QString &string);
+    static qint64 heapSize(const QByteArray &bytes);
+
+    template<class T>
+    static qint64 heapSize(const QVector<T> &vector)
+    {
+        if (vector.capacity() == 0)
+        {
+            return 0;
+        }
+        return sizeof(QArrayData) + (qint64) vector.capacity() * sizeof(T);
+    }
+
+    /* A QList holds pointers, items that do not fit in one are allocated one by one */
+    template<class T>
+    static qint64 heapSize(const QList<T> &list)
+    {
+        if (list.isEmpty())
+        {
+            return 0;
+        }
+        qint64 size = sizeof(QListData::Data) + (qint64) list.size() * sizeof(void *);
+        if (QTypeInfo<T>::isLarge || QTypeInfo<T>::isStatic)
+        {
+            size += (qint64) list.size() * sizeof(T);
+        }
+        return size;
+    }
+
+private:
+    MemoryUtils() {}
+};
+
+#endif // MEMORYUTILS_H